@@ -18,6 +18,9 @@ extern MainWindow *g_mainWindowP;
 int minfilter = 1;
 int maxfilter = 99;
 
+// max Gaussian sigma; the sigma slider moves in tenths of a pixel
+double maxsigma = 25.0;
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // Blur::Blur
 //
@@ -51,9 +54,12 @@ Blur::applyFilter(ImagePtr I1, ImagePtr I2)
 	if (xsz < minfilter || xsz > maxfilter || ysz < minfilter || ysz > maxfilter)
 		return 0;
 
+	// a nonzero sigma replaces the box by a Gaussian approximated with 3 box passes
+	BlurParams params(xsz, ysz);
+	params.sigma = m_spinBoxS->value();
+
 	// apply filter
-	blur (I1, xsz, ysz, I2);
-	return 1;
+	return blur(I1, params, I2);
 }
 
 
@@ -114,6 +120,26 @@ Blur::controlPanel()
 	m_checkBox = new QCheckBox(m_ctrlGrp);
 	m_checkBox->setChecked(true);
 
+	// create label for sigma
+	QLabel *slabel = new QLabel;
+	slabel->setText(QString("Sigma"));
+
+	// create sigma slider
+	m_sliderS = new QSlider(Qt::Horizontal, m_ctrlGrp);
+	m_sliderS->setTickPosition(QSlider::TicksBelow);
+	m_sliderS->setTickInterval(25);
+	m_sliderS->setMinimum(0);
+	m_sliderS->setMaximum(maxsigma * 10);
+	m_sliderS->setValue  (0);
+
+	// create sigma spinbox
+	m_spinBoxS = new QDoubleSpinBox(m_ctrlGrp);
+	m_spinBoxS->setMinimum(0);
+	m_spinBoxS->setMaximum(maxsigma);
+	m_spinBoxS->setValue  (0);
+	m_spinBoxS->setSingleStep(0.1);
+	m_spinBoxS->setDecimals(1);
+
 	// init signal/slot connections for Width
 	connect(m_sliderW , SIGNAL(valueChanged(int)), this, SLOT(changeWidth (int)));
 	connect(m_spinBoxW, SIGNAL(valueChanged(int)), this, SLOT(changeWidth (int)));
@@ -125,6 +151,10 @@ Blur::controlPanel()
 	// init signal/slot connections for checkbox
 	connect(m_checkBox, SIGNAL(stateChanged(int)), this, SLOT(changeBoth (int)));
 
+	// init signal/slot connections for sigma
+	connect(m_sliderS , SIGNAL(valueChanged(int   )), this, SLOT(changeSigma (int   )));
+	connect(m_spinBoxS, SIGNAL(valueChanged(double)), this, SLOT(changeSigma (double)));
+
 	// assemble dialog
   QGridLayout *layout = new QGridLayout;
   layout->addWidget(	wlabel		, 0, 0);
@@ -134,6 +164,9 @@ Blur::controlPanel()
   layout->addWidget(m_sliderH , 1, 1);
   layout->addWidget(m_spinBoxH, 1, 2);
 	layout->addWidget(m_checkBox, 1, 3);
+	layout->addWidget(	slabel		, 2, 0);
+	layout->addWidget(m_sliderS , 2, 1);
+	layout->addWidget(m_spinBoxS, 2, 2);
 
 	// assign layout to group box
 	m_ctrlGrp->setLayout(layout);
@@ -233,200 +266,45 @@ Blur::changeBoth(int value)
 
 
 
-
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-// Blur::blur:
+// Blur::changeSigma:
 //
-//! \brief    Blur sends all rows first to IP_blur1D then it sends all columns to IP_blur1D
-//! \details	First apply blur horizontally and then apply blur vertically and output to I2.
-//! \param[in]	I1  - Input image.
-//! \param[in]	xsz - filter Width.
-//! \param[in]	ysz - filter Height.
-//! \param[out]	I2  - Output image.
+// Slot to process change in Gaussian sigma caused by moving the slider.
+// A sigma of 0 returns to the box filter set by width and height.
 //
 void
-Blur::blur(ImagePtr I1, int xsz, int ysz, ImagePtr I2) {
-	int w = I1->width();
-	int h = I1->height();
-	int total = w * h;
-
-	// error checking
-	// If window width is greater than image width than we divide it by 2 and subtract 1 to make it odd
-	if (xsz > w) {
-		IP_copyImage(I1, I2);
-		return;
-	}
-
-	// If window height is greater than image height than we divide it by 2 and subtract 1 to make it odd
-	if (ysz > h) {
-		IP_copyImage(I1, I2);
-		return;
-	}
+Blur::changeSigma(int value)
+{
+	m_spinBoxS->blockSignals(true);
+	m_spinBoxS->setValue    (value / 10.);
+	m_spinBoxS->blockSignals(false);
 
-	// trivial case:
-	// if Width and Height are 1 the window size is 0 and no blurring needs to be done
-	// we simple copy input image to output image
-	if (xsz <= 1 && ysz<= 1){
-		if (I1 != I2)
-			IP_copyImage(I1, I2);
-		return;
-	}
+	// apply filter to source image; save result in destination image
+	applyFilter(g_mainWindowP->imageSrc(), g_mainWindowP->imageDst());
 
-	IP_copyImageHeader(I1, I2);
-	int type;
-	ChannelPtr<uchar> src, dst;
-	ChannelPtr<float> fsrc, fdst;
-
-	for(int ch = 0; IP_getChannel(I1, ch, src, type); ch++) {
-		// type is uchar pixel
-		if (type == UCHAR_TYPE) {
-			if (xsz > 1.) {
-				dst = I2[ch];
-				// process all rows first
-				for (int y =0; y<h; y++) {
-					// send one row at a time to IP_blur1D
-					IP_blur1D(src, w, 1, xsz, dst);
-					src += w;
-					dst += w;
-				}
-				src = I2[ch];
-			}
-
-		  if (ysz > 1.) {
-				dst = I2[ch];
-				// process all columns second
-				for (int x =0; x<w; x++) {
-					// send one column at a time to IP_blur1D
-					IP_blur1D(src, h, w, ysz, dst);
-					src += 1;
-					dst += 1;
-				}
-			}
-		}
-
-		// float type from image copying
-		else {
-			IP_castChannel(I1, ch, I2, ch, FLOAT_TYPE);
-			if (xsz > 1.) {
-				fdst = I2[ch];
-				fsrc = I2[ch];
-				// process all rows first
-				for (int y =0; y<h; y++) {
-					// send one row at a time to IP_blur1D
-					IP_blur1D(fsrc, w, 1, xsz, fdst);
-					fsrc += w;
-					fdst += w;
-				}
-				fsrc = I2[ch];
-			}
-
-			if (ysz > 1.) {
-				fdst = I2[ch];
-				// process all columns second
-				for (int x =0; x<w; x++) {
-					// send one column at a time to IP_blur1D
-					IP_blur1D(fsrc, h, w, ysz, fdst);
-					fsrc += 1;
-					fdst += 1;
-				}
-			}
-		}
-	}
+	// display output
+	g_mainWindowP->displayOut();
 }
 
 
 
-
-//IP_blur1D applies blur in 1 direction only
-//len is the length of the Image
-//stride is the distance from 1 element to next
-//ww is the width of the filter
-//src is the pointer to input Image
-//dst is the pointer to output Image
-template <class T>
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Blur::changeSigma:
+//
+// Slot to process change in Gaussian sigma caused by the spinbox.
+//
 void
-Blur::IP_blur1D(ChannelPtr<T> src, int len, int stride, double ww, ChannelPtr<T> dst) {
-
-	// buffer size is length of image + filter width - 1
-	size_t buf_size = len + ww -1;
-
-	// padding is the extra spaces to pad around the image
-	int padding = (ww - 1)/2;
-
-	// error checking
-	if (ww > len) {
-		return;
-	}
-
-	// trivial  case
-	if (ww <= 1) {
-		if (src != dst) {
-			for (int i =0; i<len; i++) {
-				*dst = *src;
-				dst += stride;
-				src += stride;
-			}
-		}
-		return;
-	}
-
-	// creating buffer
-	uint16_t *buffer;
-	buffer = (uint16_t*)malloc(sizeof(uint16_t*) * buf_size);
-	if (buffer == NULL) {
-		exit(0);
-	}
-
-	int i = 0;
-	// filling up left padded spaces
-	for (; i<padding; ++i) {
-		buffer[i] = (*src);
-	}
-
-	// incrementing length of image by left padding
-	len += i;
+Blur::changeSigma(double value)
+{
+	m_sliderS->blockSignals(true);
+	m_sliderS->setValue    (ROUND(value * 10));
+	m_sliderS->blockSignals(false);
 
-	// reading the remaining pixels in row from src to buffer
-	for (; i<len; ++i) {
-		buffer[i] = (*src);
-		src += stride;
-	}
+	// apply filter to source image; save result in destination image
+	applyFilter(g_mainWindowP->imageSrc(), g_mainWindowP->imageDst());
 
-	// decrementing src pixel back to the last pixel in the current row.
-	src -= stride;
-
-	// filling up right padded spaces
-	padding += i;
-	for (; i<padding; ++i) {
-		buffer[i] = (*src);
-		}
-
-	 // SUM //
-	 // initialize sum to 0.0
-	 double sum = 0;
-	 int j = 0;
-
-	 // for each pixel in filter width add its value to sum
-	 for (; j < ww; j++) {
-		 sum += buffer[j];
-	 }
-
-	 // output sum/ww to dst(current output pixel)
-	 *dst = sum/ww ;
-
-	 // move output image pointer to next pixel
-	 dst += stride;
-
-	 // process all the pixels remaining in the row
-	 // move filter along the row by removing the left most pixel in filter and adding the next pixel after the filter
-	 for (; j< buf_size; j++, dst += stride) {
-		 int last = j - ww;
-		 sum += (buffer[j] - buffer[last]);
-		 *dst = sum/ww;
-	 }
-
-	 // empty the buffer after 1 row is processed
-	 free (buffer);
+	// display output
+	g_mainWindowP->displayOut();
 }
 
 
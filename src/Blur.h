@@ -11,6 +11,7 @@
 #define BLUR_H
 
 #include "ImageFilter.h"
+#include "BlurKernel.h"
 
 class Blur : public ImageFilter {
 	Q_OBJECT
@@ -21,15 +22,12 @@ public:
 	bool		applyFilter(ImagePtr, ImagePtr);     // apply filter to input to init output
 	void		reset		();		                       // reset parameters
 
-protected:
-	void blur(ImagePtr I1, int xsz, int ysz, ImagePtr I2);
-	template <class T>
-	void IP_blur1D (ChannelPtr<T> src, int len, int stride, double ww, ChannelPtr<T> dst);
-
 protected slots:
 	void    changeWidth (int);
 	void    changeHeight (int);
 	void    changeBoth (int);
+	void    changeSigma (int);
+	void    changeSigma (double);
 
 private:
 	// blur controls
@@ -38,6 +36,8 @@ private:
 	QSpinBox	*m_spinBoxW;	// filter width spinbox
 	QSpinBox	*m_spinBoxH;	// filter height spinbox
 	QCheckBox *m_checkBox;  // checkbox for sz * sz filter
+	QSlider		*m_sliderS ;	// Gaussian sigma slider, in tenths; 0: box filter
+	QDoubleSpinBox	*m_spinBoxS;	// Gaussian sigma spinbox
 
 	// widgets and groupbox
 	QGroupBox	*m_ctrlGrp;	// groupbox for panel
@@ -0,0 +1,277 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// BlurKernel.cpp - Headless box blur kernel
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#include "BlurKernel.h"
+#include "ThreadPool.h"
+#include "BoxFilter.h"
+#include "IntegralImage.h"
+#include <cstdlib>
+#include <cmath>
+#include <stdint.h>
+
+static void gaussBoxes(double sigma, int n, int *sizes);
+static bool blurIntegral(ImagePtr I1, const BlurParams &params, ImagePtr I2);
+template <class A, class T>
+static void blurIntegralChannel(const T *src, T *dst, int w, int h, int xsz, int ysz, const uchar *map, int nbands);
+
+// most box passes used to approximate a Gaussian
+#define BLUR_MAXPASSES	5
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// blur:
+//
+//! \brief    Blur sends each channel to the separable box filter engine (boxBlur)
+//! \details	First apply blur horizontally and then apply blur vertically and output to I2.
+//!		If params.sigma > 0, a Gaussian is approximated instead by
+//!		params.passes successive box blurs (see gaussBoxes), so the
+//!		cost per pixel does not depend on sigma.
+//!		Even window sizes, params.integral and params.sizeMap select
+//!		the summed-area table mode instead (see blurIntegral).
+//!		That mode is a box blur, so sigma > 0 with params.integral
+//!		or params.sizeMap is rejected.
+//!		params.border picks the pixels past the edges of the box
+//!		passes; the summed-area table mode only replicates them, so
+//!		it rejects any other params.border.
+//!		Return 1 for success, 0 for failure.
+//! \param[in]	I1     - Input image.
+//! \param[in]	params - filter width and height or sigma, border mode and band count.
+//! \param[out]	I2     - Output image.
+//
+bool
+blur(ImagePtr I1, const BlurParams &params, ImagePtr I2) {
+	// error checking
+	if(I1.isNull() || params.xsz < 1 || params.ysz < 1 || params.sigma < 0) return 0;
+	if(params.sigma > 0 && (params.integral || !params.sizeMap.isNull())) return 0;
+
+	int xsz = params.xsz;
+	int ysz = params.ysz;
+	int w = I1->width();
+	int h = I1->height();
+
+	// windows that the separable box passes cannot center on a pixel
+	// or that vary across the image are summed from an integral image
+	bool even = params.sigma == 0 && (xsz % 2 == 0 || ysz % 2 == 0);
+	if (params.integral || even || !params.sizeMap.isNull())
+		return params.border.mode == BORDER_REPLICATE && blurIntegral(I1, params, I2);
+
+	// box sizes of each pass; the Gaussian mode rounds the averages of
+	// its passes so that truncation does not darken the image pass after pass
+	int  xs[BLUR_MAXPASSES], ys[BLUR_MAXPASSES];
+	int  npasses = 1;
+	bool round   = false;
+
+	if (params.sigma > 0) {
+		npasses = CLIP(params.passes, 1, BLUR_MAXPASSES);
+		gaussBoxes(params.sigma, npasses, xs);
+		for (int i = 0; i<npasses; i++) {
+			// boxes wider than the image are cut down to the widest odd box that fits
+			ys[i] = MIN(xs[i], h - !(h % 2));
+			xs[i] = MIN(xs[i], w - !(w % 2));
+		}
+		round = true;
+	}
+
+	else {
+		// If window width is greater than image width we copy input image to output image
+		if (xsz > w) {
+			IP_copyImage(I1, I2);
+			return 1;
+		}
+
+		// If window height is greater than image height we copy input image to output image
+		if (ysz > h) {
+			IP_copyImage(I1, I2);
+			return 1;
+		}
+
+		// trivial case:
+		// if Width and Height are 1 the window size is 0 and no blurring needs to be done
+		// we simple copy input image to output image
+		if (xsz <= 1 && ysz<= 1){
+			if (I1 != I2)
+				IP_copyImage(I1, I2);
+			return 1;
+		}
+
+		xs[0] = xsz;
+		ys[0] = ysz;
+	}
+
+	// split each pass into bands of lines, by default one per pool thread
+	int nbands = params.bands > 0 ? params.bands : ThreadPool::global().size();
+
+	IP_copyImageHeader(I1, I2);
+	int type;
+	ChannelPtr<uchar> src, dst;
+	ChannelPtr<float> fdst;
+
+	for(int ch = 0; IP_getChannel(I1, ch, src, type); ch++) {
+		// type is uchar pixel; later passes work in place on I2
+		if (type == UCHAR_TYPE) {
+			dst = I2[ch];
+			for (int i = 0; i<npasses; i++, src = dst)
+				boxBlur(&*src, &*dst, w, h, xs[i], ys[i], round, params.border, nbands);
+		}
+
+		// float type from image copying
+		else {
+			IP_castChannel(I1, ch, I2, ch, FLOAT_TYPE);
+			fdst = I2[ch];
+			for (int i = 0; i<npasses; i++)
+				boxBlur(&*fdst, &*fdst, w, h, xs[i], ys[i], round, params.border, nbands);
+		}
+	}
+
+	return 1;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// blurIntegral:
+//
+//! \brief	Box blur with windows of any size, summed from an integral image.
+//! \details	Each channel is tabulated once into a summed-area table, after
+//!		which every output pixel costs 4-16 lookups whatever its window.
+//!		Windows of even size reach one pixel further right (down) than
+//!		left (up). Edges are replicated, the default of the box passes.
+//!		Averages are exact, so they may exceed those of the box mode,
+//!		which truncates after each pass, by one gray level.
+//!		Return 1 for success, 0 for failure.
+//! \param[in]	I1     - Input image.
+//! \param[in]	params - largest window, optional size map, band count.
+//! \param[out]	I2     - Output image.
+//
+static bool
+blurIntegral(ImagePtr I1, const BlurParams &params, ImagePtr I2)
+{
+	int w = I1->width();
+	int h = I1->height();
+	int type;
+
+	// the size map must be a uchar image of the same size as I1
+	ChannelPtr<uchar> map;
+	const uchar *m = 0;
+	if (!params.sizeMap.isNull()) {
+		if (params.sizeMap->width() != w || params.sizeMap->height() != h)
+			return 0;
+		if (!IP_getChannel(params.sizeMap, 0, map, type) || type != UCHAR_TYPE)
+			return 0;
+		m = &*map;
+	}
+
+	int nbands = params.bands > 0 ? params.bands : ThreadPool::global().size();
+
+	// 32-bit sums do as long as the largest window sum fits
+	bool wide = integralWide(MAX(w, params.xsz), MAX(h, params.ysz));
+
+	IP_copyImageHeader(I1, I2);
+	ChannelPtr<uchar> src, dst;
+	ChannelPtr<float> fdst;
+
+	for(int ch = 0; IP_getChannel(I1, ch, src, type); ch++) {
+		// the table is built before any output is written, so src may be dst
+		if (type == UCHAR_TYPE) {
+			dst = I2[ch];
+			if (wide)
+				blurIntegralChannel<uint64_t>(&*src, &*dst, w, h, params.xsz, params.ysz, m, nbands);
+			else	blurIntegralChannel<uint32_t>(&*src, &*dst, w, h, params.xsz, params.ysz, m, nbands);
+		}
+
+		// float type from image copying
+		else {
+			IP_castChannel(I1, ch, I2, ch, FLOAT_TYPE);
+			fdst = I2[ch];
+			blurIntegralChannel<double>(&*fdst, &*fdst, w, h, params.xsz, params.ysz, m, nbands);
+		}
+	}
+
+	return 1;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// blurIntegralChannel:
+//
+//! \brief	Summed-area table blur of one channel.
+//! \details	A size map value v scales the window from 1 at v=0 up to
+//!		xsz x ysz at v=255. Output rows are split into nbands bands.
+//!		Integer sums are averaged with truncation, as in the box mode.
+//! \param[in]	src    - input channel.
+//! \param[out]	dst    - output channel; may equal src.
+//! \param[in]	w, h   - channel width and height.
+//! \param[in]	xsz    - (largest) window width.
+//! \param[in]	ysz    - (largest) window height.
+//! \param[in]	map    - per-pixel window scale, or 0 for fixed windows.
+//! \param[in]	nbands - no. of bands.
+//
+template <class A, class T>
+static void
+blurIntegralChannel(const T *src, T *dst, int w, int h, int xsz, int ysz, const uchar *map, int nbands)
+{
+	IntegralImage<A> sat;
+	sat.build(src, w, h);
+
+	// window size for each map value
+	int wx[MXGRAY], wy[MXGRAY];
+	for (int i = 0; i<MXGRAY; i++) {
+		wx[i] = map ? 1 + ROUND(i * (xsz-1) / (double) MaxGray) : xsz;
+		wy[i] = map ? 1 + ROUND(i * (ysz-1) / (double) MaxGray) : ysz;
+	}
+
+	int n = MIN(nbands, h);
+	ThreadPool::global().parallelFor(n, [&](int b) {
+		int y0 = (long long) h *  b    / n;
+		int y1 = (long long) h * (b+1) / n;
+		for (int y = y0; y<y1; y++) {
+			T *d = dst + (size_t) y*w;
+			const uchar *mp = map ? map + (size_t) y*w : 0;
+			for (int x = 0; x<w; x++) {
+				int v  = mp ? mp[x] : MaxGray;
+				int ax = x - (wx[v]-1)/2;
+				int ay = y - (wy[v]-1)/2;
+				A sum  = sat.sumReplicate(ax, ay, ax + wx[v], ay + wy[v]);
+				d[x]   = (T) (sum / (A) (wx[v] * wy[v]));
+			}
+		}
+	});
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// gaussBoxes:
+//
+//! \brief	Odd box sizes whose n successive passes approximate a Gaussian.
+//! \details	Each box of width w adds (w*w-1)/12 to the variance. The ideal
+//!		width sqrt(12*sigma^2/n + 1) is rounded to the odd sizes wl and
+//!		wl+2 just below and above it, and the first m passes use wl,
+//!		with m chosen so that the variances sum to sigma^2 (W. Wells,
+//!		"Efficient synthesis of Gaussian filters by cascaded uniform
+//!		filters", PAMI 1986).
+//! \param[in]	sigma - standard deviation of the Gaussian.
+//! \param[in]	n     - no. of passes.
+//! \param[out]	sizes - n box sizes.
+//
+static void
+gaussBoxes(double sigma, int n, int *sizes)
+{
+	double var = sigma * sigma;
+	int wl = (int) sqrt(12 * var / n + 1);
+	if (wl % 2 == 0) wl--;
+	if (wl < 1) wl = 1;
+
+	int m = ROUND((12 * var - n*wl*wl - 4*n*wl - 3*n) / (-4.*wl - 4));
+	m = CLIP(m, 0, n);
+	for (int i = 0; i<n; i++)
+		sizes[i] = i < m ? wl : wl + 2;
+}
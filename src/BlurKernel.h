@@ -0,0 +1,39 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// BlurKernel.h - Headless box blur kernel
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#ifndef BLURKERNEL_H
+#define BLURKERNEL_H
+
+#include "IP.h"
+#include "Border.h"
+using namespace IP;
+
+// ----------------------------------------------------------------------
+// blur parameters; filled in by the Blur widget or by a batch job
+//
+struct BlurParams {
+	int	xsz;		// filter width
+	int	ysz;		// filter height
+	double	sigma;		// > 0: Gaussian of this sigma instead of a box
+	int	passes;		// no. of box passes approximating the Gaussian (3-5)
+	bool	integral;	// sum box windows from a summed-area table
+	ImagePtr sizeMap;	// optional uchar image scaling each pixel's window
+				// from 1x1 (0) to xsz x ysz (255); implies integral
+	Border	border;		// pixels past the edges; the integral mode takes
+				// only BORDER_REPLICATE
+	int	bands;		// no. of bands each pass is split into; they run on the
+				// global thread pool. 0: one per pool thread, 1: serial
+
+	BlurParams(int x = 1, int y = 1, int b = 0)
+		: xsz(x), ysz(y), sigma(0), passes(3), integral(false), bands(b) {}
+};
+
+bool	blur(ImagePtr I1, const BlurParams &params, ImagePtr I2);
+
+#endif	// BLURKERNEL_H
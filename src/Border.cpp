@@ -0,0 +1,40 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// Border.cpp - Edge handling shared by the neighborhood filters
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#include "Border.h"
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Border::remap:
+//
+//! \brief	Index of the pixel standing in for pixel i outside a line.
+//! \details	Windows may reach further past an edge than the line is long,
+//!		so reflection and wrapping repeat with period 2n and n.
+//!		Return -1 in constant mode.
+//! \param[in]	i - pixel index; i < 0 or i >= n.
+//! \param[in]	n - no. of pixels in the line.
+//
+int
+Border::remap(int i, int n) const
+{
+	switch(mode) {
+	case BORDER_REFLECT:
+		i %= 2*n;
+		if(i < 0) i += 2*n;
+		return i < n ? i : 2*n-1 - i;
+	case BORDER_WRAP:
+		i %= n;
+		return i < 0 ? i + n : i;
+	case BORDER_CONSTANT:
+		return -1;
+	default:
+		return i < 0 ? 0 : n-1;
+	}
+}
@@ -0,0 +1,58 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// Border.h - Edge handling shared by the neighborhood filters
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#ifndef BORDER_H
+#define BORDER_H
+
+#include <cstddef>
+
+// how pixels past the image edge are made up; for a line abcd:
+// replicate aa|abcd|dd, reflect ba|abcd|dc, wrap cd|abcd|ab, constant vv|abcd|vv
+enum { BORDER_REPLICATE, BORDER_REFLECT, BORDER_WRAP, BORDER_CONSTANT };
+
+//////////////////////////////////////////////////////////////////////////
+///
+/// \class Border
+/// \brief Border mode of a neighborhood filter.
+///
+/// Filters ask for pixel i of a line of n pixels through index(), which
+/// returns i itself inside the line and otherwise the index of the
+/// pixel that stands in for it, or -1 if the constant value does.
+/// Only the index check is inline: filters run their interior without
+/// calling it at all and use it for the few pixels near the edges, so
+/// no line has to be copied into a padded buffer first.
+///
+//////////////////////////////////////////////////////////////////////////
+
+class Border {
+public:
+	Border	(int m = BORDER_REPLICATE, int v = 0) : mode(m), value(v) {}
+
+	int	index	(int i, int n) const
+		{ return (unsigned) i < (unsigned) n ? i : remap(i, n); }
+
+	// pixel i of a line of n pixels, step pixels apart
+	template <class T>
+	T	pixel	(const T *line, int i, int n, ptrdiff_t step = 1) const
+		{ int j = index(i, n); return j < 0 ? (T) value : line[j * step]; }
+
+	// row y of a w x h channel; constant rows point to crow,
+	// a row of w pixels set to value by the caller
+	template <class T>
+	const T*row	(const T *src, int w, int h, int y, const T *crow) const
+		{ int j = index(y, h); return j < 0 ? crow : src + (size_t) j * w; }
+
+	int	mode;	// BORDER_REPLICATE, BORDER_REFLECT, BORDER_WRAP or BORDER_CONSTANT
+	int	value;	// pixel value past the edges in BORDER_CONSTANT mode
+
+private:
+	int	remap	(int i, int n) const;	// index() of i outside 0..n-1
+};
+
+#endif	// BORDER_H
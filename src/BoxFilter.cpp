@@ -0,0 +1,470 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// BoxFilter.cpp - Separable box filter engine shared by Blur and Sharpen
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#include "BoxFilter.h"
+#include "ThreadPool.h"
+#include "Scratch.h"
+#include <cstring>
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BOX_X86
+#include <immintrin.h>
+#endif
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// BoxDivisor::BoxDivisor:
+//
+// Constructor. Search for the smallest shift whose rounded-up reciprocal
+// gives exact quotients for all sums 0..255*ww; the check is exhaustive
+// but only runs once per filter size per pass. The multiplier and the
+// biased sums must fit in 16 bits so that the SIMD code can use a
+// high-half 16-bit multiply.
+//
+BoxDivisor::BoxDivisor(int ww, bool round)
+	: ww(ww > 0 ? ww : 1), bias(0), mul(0), shift(0)
+{
+	if(round) bias = this->ww / 2;
+	if(this->ww == 1 || 255 * this->ww + bias > 0xFFFF) return;
+
+	uint32_t maxsum = 255 * this->ww + bias;
+	for(int s = 16; s < 32; ++s) {
+		uint64_t m = ((1ULL << s) + this->ww - 1) / this->ww;
+		if(m > 0xFFFF) break;
+
+		uint32_t sum;
+		for(sum = bias; sum <= maxsum; ++sum)
+			if(((sum * m) >> s) != sum / this->ww) break;
+		if(sum > maxsum) {
+			mul   = (uint32_t) m;
+			shift = s;
+			return;
+		}
+	}
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// scalar versions; also used for the tail of each SIMD loop
+//
+static void
+addRowScalar(uint16_t *sum, const uint8_t *in, const uint8_t *out, int n)
+{
+	for(int x = 0; x < n; ++x)
+		sum[x] += in[x] - out[x];
+}
+
+static void
+divideRowScalar(const uint16_t *sum, const BoxDivisor &d, uint8_t *dst, int n)
+{
+	for(int x = 0; x < n; ++x)
+		dst[x] = d.divide(sum[x]);
+}
+
+
+
+#ifdef BOX_X86
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// SSE2 versions: 16 pixels per iteration. SSE2 is always present on x86-64.
+//
+__attribute__((target("sse2")))
+static void
+addRowSSE2(uint16_t *sum, const uint8_t *in, const uint8_t *out, int n)
+{
+	__m128i zero = _mm_setzero_si128();
+	int x = 0;
+	for(; x + 16 <= n; x += 16) {
+		__m128i a  = _mm_loadu_si128((const __m128i *) (in  + x));
+		__m128i b  = _mm_loadu_si128((const __m128i *) (out + x));
+		__m128i s0 = _mm_loadu_si128((const __m128i *) (sum + x));
+		__m128i s1 = _mm_loadu_si128((const __m128i *) (sum + x + 8));
+		s0 = _mm_sub_epi16(_mm_add_epi16(s0, _mm_unpacklo_epi8(a, zero)), _mm_unpacklo_epi8(b, zero));
+		s1 = _mm_sub_epi16(_mm_add_epi16(s1, _mm_unpackhi_epi8(a, zero)), _mm_unpackhi_epi8(b, zero));
+		_mm_storeu_si128((__m128i *) (sum + x),     s0);
+		_mm_storeu_si128((__m128i *) (sum + x + 8), s1);
+	}
+	addRowScalar(sum + x, in + x, out + x, n - x);
+}
+
+__attribute__((target("sse2")))
+static void
+divideRowSSE2(const uint16_t *sum, const BoxDivisor &d, uint8_t *dst, int n)
+{
+	__m128i bias  = _mm_set1_epi16((short) d.bias);
+	__m128i mul   = _mm_set1_epi16((short) d.mul);
+	__m128i shift = _mm_cvtsi32_si128(d.shift - 16);
+	int x = 0;
+	for(; x + 16 <= n; x += 16) {
+		__m128i s0 = _mm_add_epi16(_mm_loadu_si128((const __m128i *) (sum + x)),     bias);
+		__m128i s1 = _mm_add_epi16(_mm_loadu_si128((const __m128i *) (sum + x + 8)), bias);
+		s0 = _mm_srl_epi16(_mm_mulhi_epu16(s0, mul), shift);
+		s1 = _mm_srl_epi16(_mm_mulhi_epu16(s1, mul), shift);
+		_mm_storeu_si128((__m128i *) (dst + x), _mm_packus_epi16(s0, s1));
+	}
+	divideRowScalar(sum + x, d, dst + x, n - x);
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// AVX2 versions: 32 pixels per iteration.
+//
+__attribute__((target("avx2")))
+static void
+addRowAVX2(uint16_t *sum, const uint8_t *in, const uint8_t *out, int n)
+{
+	int x = 0;
+	for(; x + 32 <= n; x += 32) {
+		__m256i a0 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (in  + x)));
+		__m256i a1 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (in  + x + 16)));
+		__m256i b0 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (out + x)));
+		__m256i b1 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (out + x + 16)));
+		__m256i s0 = _mm256_loadu_si256((const __m256i *) (sum + x));
+		__m256i s1 = _mm256_loadu_si256((const __m256i *) (sum + x + 16));
+		s0 = _mm256_sub_epi16(_mm256_add_epi16(s0, a0), b0);
+		s1 = _mm256_sub_epi16(_mm256_add_epi16(s1, a1), b1);
+		_mm256_storeu_si256((__m256i *) (sum + x),      s0);
+		_mm256_storeu_si256((__m256i *) (sum + x + 16), s1);
+	}
+	addRowScalar(sum + x, in + x, out + x, n - x);
+}
+
+__attribute__((target("avx2")))
+static void
+divideRowAVX2(const uint16_t *sum, const BoxDivisor &d, uint8_t *dst, int n)
+{
+	__m256i bias  = _mm256_set1_epi16((short) d.bias);
+	__m256i mul   = _mm256_set1_epi16((short) d.mul);
+	__m128i shift = _mm_cvtsi32_si128(d.shift - 16);
+	int x = 0;
+	for(; x + 32 <= n; x += 32) {
+		__m256i s0 = _mm256_add_epi16(_mm256_loadu_si256((const __m256i *) (sum + x)),      bias);
+		__m256i s1 = _mm256_add_epi16(_mm256_loadu_si256((const __m256i *) (sum + x + 16)), bias);
+		s0 = _mm256_srl_epi16(_mm256_mulhi_epu16(s0, mul), shift);
+		s1 = _mm256_srl_epi16(_mm256_mulhi_epu16(s1, mul), shift);
+
+		// packus works within 128-bit lanes; restore pixel order
+		__m256i p = _mm256_permute4x64_epi64(_mm256_packus_epi16(s0, s1), 0xD8);
+		_mm256_storeu_si256((__m256i *) (dst + x), p);
+	}
+	divideRowScalar(sum + x, d, dst + x, n - x);
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// hasAVX2:
+//
+// Return 1 if the CPU we run on supports AVX2; checked once.
+//
+static bool
+hasAVX2()
+{
+	static const bool avx2 = __builtin_cpu_supports("avx2");
+	return avx2;
+}
+#endif	// BOX_X86
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// boxAddRowU8:
+//
+//! \brief	Slide n running column sums down by one row.
+//! \details	sum[x] += in[x] - out[x]; the sums stay exact as long as the
+//!		window is at most BOX_MAXU16 pixels.
+//! \param[in,out] sum - running sums.
+//! \param[in]	in   - row entering the window.
+//! \param[in]	out  - row leaving the window.
+//! \param[in]	n    - no. of pixels.
+//
+void
+boxAddRowU8(uint16_t *sum, const uint8_t *in, const uint8_t *out, int n)
+{
+#ifdef BOX_X86
+	if(hasAVX2())	addRowAVX2(sum, in, out, n);
+	else		addRowSSE2(sum, in, out, n);
+#else
+	addRowScalar(sum, in, out, n);
+#endif
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// boxDivideRowU8:
+//
+//! \brief	Write the box average of n running sums.
+//! \details	dst[x] = (sum[x] + d.bias) / d.ww, computed with d's reciprocal.
+//! \param[in]	sum - running sums.
+//! \param[in]	d   - divisor for the window size.
+//! \param[out]	dst - output pixels.
+//! \param[in]	n   - no. of pixels.
+//
+void
+boxDivideRowU8(const uint16_t *sum, const BoxDivisor &d, uint8_t *dst, int n)
+{
+#ifdef BOX_X86
+	if(!d.mul)		divideRowScalar(sum, d, dst, n);
+	else if(hasAVX2())	divideRowAVX2(sum, d, dst, n);
+	else			divideRowSSE2(sum, d, dst, n);
+#else
+	divideRowScalar(sum, d, dst, n);
+#endif
+}
+
+
+
+// ----------------------------------------------------------------------
+// sum type of a row window: exact int sums for uchar, double for float
+//
+template <class T> struct BoxSum		{ typedef int	 type; };
+template <>	   struct BoxSum<float>	{ typedef double type; };
+
+static inline void boxStore(uint8_t &p, int    sum, const BoxDivisor &d) { p = d.divide(sum); }
+static inline void boxStore(float   &p, double sum, const BoxDivisor &d) { p = sum / d.ww; }
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// boxBlurRow:
+//
+//! \brief	Box blur one row.
+//! \details	A running sum moves along the row adding the entering pixel
+//!		and removing the leaving one. The stand-ins for the top pixels
+//!		before the row and the bot pixels after it are looked up from
+//!		b once, so only the first and last few outputs check where
+//!		their pixels come from and the rest of the row reads src
+//!		directly. If src equals dst, the row is copied first.
+//! \param[in]	src - input row.
+//! \param[in]	len - no. of pixels.
+//! \param[in]	d   - filter width and its reciprocal.
+//! \param[in]	b   - border mode.
+//! \param[out]	dst - output row.
+//
+template <class T>
+void
+boxBlurRow(const T *src, int len, const BoxDivisor &d, const Border &b, T *dst)
+{
+	int ww = d.ww;
+
+	// trivial case
+	if(ww <= 1) {
+		if(src != dst) memcpy(dst, src, len * sizeof(T));
+		return;
+	}
+
+	// pixels x-top .. x+bot contribute to output pixel x
+	int top = (ww - 1) / 2;
+	int bot = ww - 1 - top;
+
+	// stand-ins for pixels -top .. -1 and len .. len+bot-1, in this thread's scratch arena
+	Scratch scratch;
+	T *head = scratch.alloc<T>(top);
+	T *tail = scratch.alloc<T>(bot);
+	for(int i = 0; i < top; ++i)
+		head[i] = b.pixel(src, i - top, len);
+	for(int i = 0; i < bot; ++i)
+		tail[i] = b.pixel(src, len + i, len);
+	if(src == dst) {
+		T *row = scratch.alloc<T>(len);
+		memcpy(row, src, len * sizeof(T));
+		src = row;
+	}
+	auto at = [&](int i) { return i < 0 ? head[i + top] : i < len ? src[i] : tail[i - len]; };
+
+	typename BoxSum<T>::type sum = 0;
+	for(int i = -top; i <= bot; ++i)
+		sum += at(i);
+	boxStore(dst[0], sum, d);
+
+	// pixels x-top-1 (leaving) and x+bot (entering) lie in the row for x in [x0,x1)
+	int x0 = std::min(top + 1, len);
+	int x1 = std::max(x0, len - bot);
+	int x  = 1;
+	for(; x < x0; ++x) {
+		sum += at(x + bot) - at(x - top - 1);
+		boxStore(dst[x], sum, d);
+	}
+	for(; x < x1; ++x) {
+		sum += src[x + bot] - src[x - top - 1];
+		boxStore(dst[x], sum, d);
+	}
+	for(; x < len; ++x) {
+		sum += at(x + bot) - at(x - top - 1);
+		boxStore(dst[x], sum, d);
+	}
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// slideColumns:
+//
+//! \brief	Blur a strip of adjacent columns vertically.
+//! \details	Instead of walking each column with stride w, the strip keeps
+//!		one running sum per column and moves down the image a row
+//!		segment at a time, so memory is read and written linearly.
+//!		The last ww input rows are kept in a ring buffer; this lets
+//!		src equal dst, since rows are overwritten after they are read.
+//!		Rows past the top and bottom edges are picked by b; those past
+//!		the bottom are copied before any output is written, since with
+//!		src equal to dst they may reflect or wrap onto written rows.
+//!		S is the column sum type (see boxAddRow).
+//! \param[in]	src  - first pixel of the strip in the input channel.
+//! \param[in]	w    - row stride of the channel.
+//! \param[in]	h    - no. of rows.
+//! \param[in]	cols - no. of columns in the strip.
+//! \param[in]	d    - filter height and its reciprocal.
+//! \param[in]	b    - border mode.
+//! \param[out]	dst  - first pixel of the strip in the output channel.
+//
+template <class T, class S>
+static void
+slideColumns(const T *src, int w, int h, int cols, const BoxDivisor &d, const Border &b, T *dst)
+{
+	// rows y-top .. y+bot contribute to output row y
+	int ww  = d.ww;
+	int top = (ww - 1) / 2;
+	int bot = ww - 1 - top;
+
+	// sum[] holds the running sum of each column;
+	// ring[] holds input row k in slot (k+top) % ww; zero[] is an empty row,
+	// crow[] the row of constant pixels past the edges, tail[] the bot rows past the bottom
+	Scratch scratch;
+	S *sum  = scratch.alloc<S>(cols);
+	T *ring = scratch.alloc<T>((size_t) ww * cols);
+	T *zero = scratch.alloc<T>(cols);
+	T *crow = scratch.alloc<T>(cols);
+	T *tail = scratch.alloc<T>((size_t) bot * cols);
+	memset(sum,  0, cols * sizeof(S));
+	memset(zero, 0, cols * sizeof(T));
+	std::fill(crow, crow + cols, (T) b.value);
+	for(int k = 0; k < bot; ++k)
+		memcpy(&tail[(size_t) k * cols], b.row(src, w, h, h + k, crow), cols * sizeof(T));
+
+	// fill the window for output row 0
+	for(int k = -top; k <= bot; ++k) {
+		const T *s = b.row(src, w, h, k, crow);
+		T *r = &ring[(size_t) (k + top) * cols];
+		memcpy(r, s, cols * sizeof(T));
+		boxAddRow(sum, r, zero, cols);
+	}
+
+	for(int y = 0; y < h; ++y) {
+		// output sum/ww to current output row
+		boxDivideRow(sum, d, dst + (size_t) y * w, cols);
+
+		if(y == h-1) break;
+
+		// slide the window down: row y-top leaves, row y+bot+1 enters in its slot
+		int yin = y + bot + 1;
+		const T *s = yin < h ? src + (size_t) yin * w : &tail[(size_t) (yin - h) * cols];
+		T *r = &ring[(size_t) (y % ww) * cols];
+		boxAddRow(sum, s, r, cols);
+		memcpy(r, s, cols * sizeof(T));
+	}
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// boxBlurColumns:
+//
+// Vertical box blur of a strip of cols columns (see slideColumns).
+// uchar strips use 16-bit column sums and the SIMD row operations
+// unless the window is too tall for them.
+//
+template <>
+void
+boxBlurColumns<uint8_t>(const uint8_t *src, int w, int h, int cols, const BoxDivisor &d, const Border &b, uint8_t *dst)
+{
+	if(d.ww <= BOX_MAXU16)
+		slideColumns<uint8_t, uint16_t>(src, w, h, cols, d, b, dst);
+	else	slideColumns<uint8_t, int>     (src, w, h, cols, d, b, dst);
+}
+
+template <>
+void
+boxBlurColumns<float>(const float *src, int w, int h, int cols, const BoxDivisor &d, const Border &b, float *dst)
+{
+	slideColumns<float, double>(src, w, h, cols, d, b, dst);
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// boxBlur:
+//
+//! \brief	Box blur one channel: all rows first, then all columns.
+//! \details	Lines are independent, so each pass is split into nbands bands
+//!		of adjacent rows (columns) that run on the global thread pool;
+//!		the column bands work in strips of BOX_STRIP columns.
+//! \param[in]	src    - input channel.
+//! \param[out]	dst    - output channel; may equal src.
+//! \param[in]	w, h   - channel width and height.
+//! \param[in]	xsz    - filter width.
+//! \param[in]	ysz    - filter height.
+//! \param[in]	round  - round uchar averages instead of truncating.
+//! \param[in]	border - border mode.
+//! \param[in]	nbands - no. of bands per pass.
+//
+template <class T>
+void
+boxBlur(const T *src, T *dst, int w, int h, int xsz, int ysz, bool round, const Border &border, int nbands)
+{
+	ThreadPool &pool = ThreadPool::global();
+	BoxDivisor dx(xsz, round), dy(ysz, round);
+
+	// scratch needed by one line of the row pass or one strip of the column pass;
+	// each band reserves it up front so its lines never touch the heap
+	size_t rowScratch   = (w + xsz) * sizeof(T) + 3*32;
+	size_t stripScratch = BOX_STRIP * (sizeof(double) + (ysz+ysz/2+2) * sizeof(T)) + 5*32;
+	size_t scratch      = std::max(rowScratch, stripScratch);
+
+	if(xsz > 1) {
+		// process all rows first; each band blurs its rows one at a time
+		int n = std::min(nbands, h);
+		pool.parallelFor(n, [&](int b) {
+			int y0 = (long long) h *  b    / n;
+			int y1 = (long long) h * (b+1) / n;
+			Scratch::reserve(scratch);
+			for(int y = y0; y < y1; ++y)
+				boxBlurRow(src + (size_t) y*w, w, dx, border, dst + (size_t) y*w);
+		});
+		src = dst;
+	}
+
+	if(ysz > 1) {
+		// process all columns second; each band blurs its columns in strips
+		int n = std::min(nbands, w);
+		pool.parallelFor(n, [&](int b) {
+			int x0 = (long long) w *  b    / n;
+			int x1 = (long long) w * (b+1) / n;
+			Scratch::reserve(scratch);
+			for(int x = x0; x < x1; x += BOX_STRIP)
+				boxBlurColumns(src + x, w, h, std::min(BOX_STRIP, x1-x), dy, border, dst + x);
+		});
+	}
+
+	// a 1x1 box (a Gaussian pass cut down to a one-pixel image side) copies
+	else if(xsz <= 1 && src != dst)
+		memcpy(dst, src, (size_t) w * h * sizeof(T));
+}
+
+
+
+// the pixel types in use
+template void boxBlurRow<uint8_t>(const uint8_t *, int, const BoxDivisor &, const Border &, uint8_t *);
+template void boxBlurRow<float>  (const float *,   int, const BoxDivisor &, const Border &, float *);
+template void boxBlur<uint8_t>(const uint8_t *, uint8_t *, int, int, int, int, bool, const Border &, int);
+template void boxBlur<float>  (const float *,   float *,   int, int, int, int, bool, const Border &, int);
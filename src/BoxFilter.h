@@ -0,0 +1,77 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// BoxFilter.h - Separable box filter engine shared by Blur and Sharpen
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#ifndef BOXFILTER_H
+#define BOXFILTER_H
+
+#include "Border.h"
+#include <stdint.h>
+
+// largest window whose uchar sums fit in uint16_t accumulators
+#define BOX_MAXU16	(65535 / 255)
+
+// no. of adjacent columns blurred together in the vertical pass
+#define BOX_STRIP	256
+
+// ----------------------------------------------------------------------
+// fixed-point reciprocal of a box window size:
+// (sum+bias)/ww == ((sum+bias)*mul) >> shift for every sum a window of
+// uchar pixels can produce. bias is 0 (truncate) or ww/2 (round).
+// If no such pair exists, mul is 0 and divide() uses integer division.
+//
+struct BoxDivisor {
+	int	ww;		// window size (no. of pixels summed)
+	uint32_t bias;		// added to the sum before dividing
+	uint32_t mul;		// reciprocal multiplier; 0 if none is exact
+	int	shift;		// shift applied after the multiply (>= 16)
+
+	BoxDivisor(int ww = 1, bool round = false);
+	int	divide(uint32_t sum) const
+		{ sum += bias; return mul ? (int) ((sum * mul) >> shift) : (int) (sum / ww); }
+};
+
+// ----------------------------------------------------------------------
+// row segment operations used by the vertical pass; n pixels each.
+// AVX2 or SSE2 code is picked at run time; scalar code elsewhere.
+//
+void	boxAddRowU8	(uint16_t *sum, const uint8_t *in, const uint8_t *out, int n);
+void	boxDivideRowU8	(const uint16_t *sum, const BoxDivisor &d, uint8_t *dst, int n);
+
+// ----------------------------------------------------------------------
+// the same for other column sums: sum[x] += in[x] - out[x] and
+// dst[x] = sum[x] / d.ww. uint16_t sums of uchar rows take the SIMD code,
+// int sums of uchar rows use d.divide(), double sums of float rows are exact.
+//
+inline void	boxAddRow	(uint16_t *sum, const uint8_t *in, const uint8_t *out, int n)
+		{ boxAddRowU8(sum, in, out, n); }
+inline void	boxDivideRow	(const uint16_t *sum, const BoxDivisor &d, uint8_t *dst, int n)
+		{ boxDivideRowU8(sum, d, dst, n); }
+inline void	boxDivideRow	(const int *sum, const BoxDivisor &d, uint8_t *dst, int n)
+		{ for(int x = 0; x < n; ++x) dst[x] = d.divide(sum[x]); }
+inline void	boxDivideRow	(const double *sum, const BoxDivisor &d, float *dst, int n)
+		{ for(int x = 0; x < n; ++x) dst[x] = sum[x] / d.ww; }
+
+template <class S, class T>
+inline void	boxAddRow	(S *sum, const T *in, const T *out, int n)
+		{ for(int x = 0; x < n; ++x) sum[x] += in[x] - out[x]; }
+
+// ----------------------------------------------------------------------
+// separable box blur; instantiated for uint8_t and float pixels.
+// Windows span x-(ww-1)/2 .. x+ww/2 and pixels past the edges come
+// from the border mode b. src may equal dst in all three.
+//
+template <class T>
+void	boxBlurRow	(const T *src, int len, const BoxDivisor &d, const Border &b, T *dst);
+template <class T>
+void	boxBlurColumns	(const T *src, int w, int h, int cols, const BoxDivisor &d, const Border &b, T *dst);
+template <class T>
+void	boxBlur		(const T *src, T *dst, int w, int h, int xsz, int ysz, bool round,
+			 const Border &b, int nbands);
+
+#endif	// BOXFILTER_H
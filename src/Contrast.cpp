@@ -61,9 +61,7 @@ Contrast::applyFilter(ImagePtr I1, ImagePtr I2)
   if ((b < min || b > max) || (c < min || c > max)) return 0;
 
 	// apply filter
-  contrast(I1, b, c, I2);
-
-	return 1;
+	return contrast(I1, ContrastParams(b, c), I2);
 }
 
 
@@ -199,61 +197,6 @@ Contrast::changeBri(int b)
 
 
 
-// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-// Contrast::contrast:
-//
-// Contrast I1 using the 2-level mapping shown below.  Output is in I2.
-//! \details	Output is in I2. val = (pixel - reference)* contr + reference + brightness
-//! \param[in]	I1  - Input image.
-//! \param[in]	brightness - Brightness.
-//! \param[in]	contrast - Contrast.
-//! \param[out]	I2  - Output image.
-//
-void
-Contrast::contrast(ImagePtr I1, double brightness, double contrast, ImagePtr I2)
-{
-	IP_copyImageHeader(I1, I2);
-	int w = I1->width();
-	int h = I1->height();
-	int total = w * h;
-
-	// fixed reference pixel intensity value.
-	// this is the intersection point between brightness & contrast
-	int reference = 128;
-
-	// contr variable to scale our contrast factor: contrast
-	double contr;
-
-	// initializing contr
-	if (contrast >= 0)
-		contr = contrast/25.0 + 1.0;
-	else
-		contr = contrast/133.0 + 1.0;
-
-	// compute lut[], i.e. lookup table
-	// initialized lut of 256 entries
-	int i, lut[MXGRAY];
-
-	// applying brightness & contrats algorithm to pixel intensities and storing their corresponding values in lut
-	// the algorithm darkens levels below our reference point and brightens levels above our reference point
-	// CLIP the value between 0 - 255 to make sure the value does not go off range
-	for(i=0; i<MXGRAY; ++i)
-		lut[i] = (int)CLIP((i - reference)* contr + reference + brightness, 0, 255);
-
-	// for each pixel intensity in I1, read its coresponding value from lut, and output it to I2
-	// p1 is a pointer that points to current pixel in I1. p1++ is pointing to next pixel in I1
-	// p2 is a pointer that points to current pixel in I2. p2++ is pointing to next pixel in I2
-	// initially p1 points to beginning of ch array
-	int type;
-	ChannelPtr<uchar> p1, p2, endd;
-	for(int ch = 0; IP_getChannel(I1, ch, p1, type); ch++) {
-		IP_getChannel(I2, ch, p2, type);
-		for(endd = p1 + total; p1<endd;) *p2++ = lut[*p1++];
-	}
-}
-
-
-
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // Contrast::reset:
 //
@@ -11,6 +11,7 @@
 #define CONTRAST_H
 
 #include "ImageFilter.h"
+#include "ContrastKernel.h"
 
 class Contrast : public ImageFilter {
 	Q_OBJECT
@@ -21,9 +22,6 @@ public:
 	bool		applyFilter(ImagePtr, ImagePtr);// apply filter to input to init output
 	void		reset		();		// reset parameters
 
-protected:
-	void contrast(ImagePtr I1, double brightness, double contrast, ImagePtr I2);
-
 protected slots:
 	void    changeCtr (int);
 	void    changeBri (int);
@@ -0,0 +1,74 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// ContrastKernel.cpp - Headless brightness/contrast kernel
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#include "ContrastKernel.h"
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// contrast:
+//
+// Contrast I1 using the 2-level mapping shown below.  Output is in I2.
+//! \details	Output is in I2. val = (pixel - reference)* contr + reference + brightness
+//!		Return 1 for success, 0 for failure.
+//! \param[in]	I1     - Input image.
+//! \param[in]	params - Brightness and contrast.
+//! \param[out]	I2     - Output image.
+//
+bool
+contrast(ImagePtr I1, const ContrastParams &params, ImagePtr I2)
+{
+	// error checking
+	if(I1.isNull()) return 0;
+
+	PointLut lut;
+	contrastLut(params, lut);
+
+	// for each pixel intensity in I1, read its coresponding value from lut, and output it to I2
+	return pointLut(I1, lut, I2);
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// contrastLut:
+//
+// Fill lut with the brightness/contrast mapping, for contrast() or a
+// fused chain. Return 1; every brightness and contrast is valid.
+//
+bool
+contrastLut(const ContrastParams &params, PointLut &lut)
+{
+	double brightness = params.brightness;
+	double contrast   = params.contrast;
+
+	// fixed reference pixel intensity value.
+	// this is the intersection point between brightness & contrast
+	int reference = 128;
+
+	// contr variable to scale our contrast factor: contrast
+	double contr;
+
+	// initializing contr
+	if (contrast >= 0)
+		contr = contrast/25.0 + 1.0;
+	else
+		contr = contrast/133.0 + 1.0;
+
+	// compute lut[], i.e. lookup table of 256 entries
+	int i;
+
+	// applying brightness & contrats algorithm to pixel intensities and storing their corresponding values in lut
+	// the algorithm darkens levels below our reference point and brightens levels above our reference point
+	// CLIP the value between 0 - 255 to make sure the value does not go off range
+	for(i=0; i<MXGRAY; ++i)
+		lut.map[i] = (int)CLIP((i - reference)* contr + reference + brightness, 0, 255);
+
+	return 1;
+}
@@ -0,0 +1,30 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// ContrastKernel.h - Headless brightness/contrast kernel
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#ifndef CONTRASTKERNEL_H
+#define CONTRASTKERNEL_H
+
+#include "IP.h"
+#include "PointLut.h"
+using namespace IP;
+
+// ----------------------------------------------------------------------
+// brightness/contrast parameters; filled in by the Contrast widget or by a batch job
+//
+struct ContrastParams {
+	double	brightness;	// brightness offset
+	double	contrast;	// contrast slider value; scaled into a factor by the kernel
+
+	ContrastParams(double b = 0, double c = 0) : brightness(b), contrast(c) {}
+};
+
+bool	contrast(ImagePtr I1, const ContrastParams &params, ImagePtr I2);
+bool	contrastLut(const ContrastParams &params, PointLut &lut);
+
+#endif	// CONTRASTKERNEL_H
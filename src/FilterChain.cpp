@@ -0,0 +1,495 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// FilterChain.cpp - Sequence of headless filter kernels parsed from a spec
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#include "FilterChain.h"
+#include "Histogram.h"
+#include <cstdlib>
+#include <cstring>
+
+// ----------------------------------------------------------------------
+// filter names accepted in a chain spec
+//
+static const struct {
+	const char	*name;
+	int		 type;
+} FilterNames[] = {
+	{"threshold",		FilterStep::THRESHOLD},
+	{"contrast",		FilterStep::CONTRAST},
+	{"quantization",	FilterStep::QUANTIZATION},
+	{"quantize",		FilterStep::QUANTIZATION},
+	{"histogramstretching",	FilterStep::HISTOGRAMSTRETCHING},
+	{"stretch",		FilterStep::HISTOGRAMSTRETCHING},
+	{"histogrammatching",	FilterStep::HISTOGRAMMATCHING},
+	{"match",		FilterStep::HISTOGRAMMATCHING},
+	{"blur",		FilterStep::BLUR},
+	{"sharpen",		FilterStep::SHARPEN},
+	{"median",		FilterStep::MEDIAN},
+};
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// filterType:
+//
+// Return the FilterStep type for name, or -1 if name is not a filter.
+//
+static int
+filterType(const std::string &name)
+{
+	int n = sizeof(FilterNames) / sizeof(FilterNames[0]);
+	for(int i = 0; i < n; ++i)
+		if(name == FilterNames[i].name) return FilterNames[i].type;
+	return -1;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// toInt / toDouble:
+//
+// Convert whole string s to a number. Return 1 for success, 0 for failure.
+//
+static bool
+toInt(const std::string &s, int &val)
+{
+	char *end;
+	if(s.empty()) return 0;
+	val = (int) strtol(s.c_str(), &end, 10);
+	return *end == 0;
+}
+
+static bool
+toDouble(const std::string &s, double &val)
+{
+	char *end;
+	if(s.empty()) return 0;
+	val = strtod(s.c_str(), &end);
+	return *end == 0;
+}
+
+// border mode: replicate, reflect, wrap, or a gray level for a constant border
+static bool
+toBorder(const std::string &s, Border &b)
+{
+	int v;
+	if(s == "replicate") b = Border(BORDER_REPLICATE);
+	else if(s == "reflect") b = Border(BORDER_REFLECT);
+	else if(s == "wrap")    b = Border(BORDER_WRAP);
+	else if(toInt(s, v) && v >= 0 && v <= MaxGray) b = Border(BORDER_CONSTANT, v);
+	else return 0;
+	return 1;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// blurIntegralOk:
+//
+// Return 0 if the summed-area table mode (sat or map) is asked for with
+// a sigma or a border other than replicate, which that mode ignores.
+//
+static bool
+blurIntegralOk(const BlurParams &p)
+{
+	if(!p.integral && p.sizeMap.isNull()) return 1;
+	return p.sigma <= 0 && p.border.mode == BORDER_REPLICATE;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// setArg:
+//
+//! \brief	Store one argument of a chain step into its parameter struct.
+//! \details	Return 1 for success, 0 for an unknown key or bad value.
+//! \param[in,out] step - step being configured.
+//! \param[in]	key  - argument name; empty for a positional argument.
+//! \param[in]	val  - argument value.
+//
+static bool
+setArg(FilterStep &step, const std::string &key, const std::string &val)
+{
+	int	i;
+	double	d;
+
+	switch(step.type) {
+	case FilterStep::THRESHOLD:
+		if(key.empty() || key == "t")
+			return toInt(val, step.threshold.thr);
+		break;
+	case FilterStep::CONTRAST:
+		if(key == "b") return toDouble(val, step.contrast.brightness);
+		if(key == "c") return toDouble(val, step.contrast.contrast);
+		break;
+	case FilterStep::QUANTIZATION:
+		if(key.empty() || key == "levels")
+			return toInt(val, step.quantization.levels);
+		if(key == "dither")
+			return toInt(val, step.quantization.dither);
+		break;
+	case FilterStep::HISTOGRAMSTRETCHING:
+		// "auto" alone sets both ends; min=auto and max=auto set one end
+		if(key.empty() && val == "auto") {
+			step.histogramstretching.autoMin = step.histogramstretching.autoMax = 1;
+			return 1;
+		}
+		if(key == "min") {
+			if(val == "auto") return (step.histogramstretching.autoMin = 1);
+			return toInt(val, step.histogramstretching.min);
+		}
+		if(key == "max") {
+			if(val == "auto") return (step.histogramstretching.autoMax = 1);
+			return toInt(val, step.histogramstretching.max);
+		}
+		if(key == "clip")
+			return toDouble(val, step.histogramstretching.clip) &&
+			       step.histogramstretching.clip >= 0 && step.histogramstretching.clip < 50;
+		if(key == "m") {
+			if(val == "pooled")  return (step.histogramstretching.mode = HistogramStretchingParams::POOLED),  1;
+			if(val == "channel") return (step.histogramstretching.mode = HistogramStretchingParams::CHANNEL), 1;
+			if(val == "luma")    return (step.histogramstretching.mode = HistogramStretchingParams::LUMA),    1;
+			return 0;
+		}
+		break;
+	case FilterStep::HISTOGRAMMATCHING:
+		if(key.empty() || key == "n")
+			return toInt(val, step.histogrammatching.n);
+		if(key == "ref")
+			return histogrammatchingReference(IP_readImage(val.c_str()), step.histogrammatching);
+		break;
+	case FilterStep::BLUR:
+		// WxH or a single size for a square filter
+		if(key.empty()) {
+			size_t x = val.find('x');
+			if(x == std::string::npos) {
+				if(!toInt(val, i)) return 0;
+				step.blur.xsz = step.blur.ysz = i;
+				return 1;
+			}
+			return toInt(val.substr(0, x), step.blur.xsz) &&
+			       toInt(val.substr(x+1),  step.blur.ysz);
+		}
+		if(key == "w") return toInt(val, step.blur.xsz);
+		if(key == "h") return toInt(val, step.blur.ysz);
+		if(key == "b") return toInt(val, step.blur.bands);
+		if(key == "e") return toBorder(val, step.blur.border) && blurIntegralOk(step.blur);
+		if(key == "s") return toDouble(val, step.blur.sigma)  && blurIntegralOk(step.blur);
+		if(key == "p") return toInt(val, step.blur.passes);
+		if(key == "sat") {
+			if(!toInt(val, i)) return 0;
+			step.blur.integral = (i != 0);
+			return blurIntegralOk(step.blur);
+		}
+		if(key == "map") {
+			step.blur.sizeMap = IP_readImage(val.c_str());
+			return !step.blur.sizeMap.isNull() && blurIntegralOk(step.blur);
+		}
+		break;
+	case FilterStep::SHARPEN:
+		if(key.empty() || key == "sz")
+			return toInt(val, step.sharpen.sz);
+		if(key == "f") {
+			if(!toDouble(val, d)) return 0;
+			step.sharpen.fctr = d;
+			return 1;
+		}
+		if(key == "b") return toInt(val, step.sharpen.bands);
+		if(key == "e") return toBorder(val, step.sharpen.border);
+		break;
+	case FilterStep::MEDIAN:
+		if(key.empty() || key == "sz")
+			return toInt(val, step.median.sz);
+		if(key == "k")
+			return toInt(val, step.median.avg_nbrs);
+		if(key == "m") {
+			if(val == "auto")     return (step.median.method = MEDIAN_AUTO),     1;
+			if(val == "huang")    return (step.median.method = MEDIAN_HUANG),    1;
+			if(val == "constant") return (step.median.method = MEDIAN_CONSTANT), 1;
+			if(val == "network")  return (step.median.method = MEDIAN_NETWORK),  1;
+			return 0;
+		}
+		if(key == "b") return toInt(val, step.median.bands);
+		if(key == "e") return toBorder(val, step.median.border);
+		break;
+	}
+	return 0;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// FilterChain::parse:
+//
+//! \brief	Parse a chain spec such as "blur:9x9,median:5,contrast:b=10,c=20".
+//! \details	Replaces any previously parsed steps.
+//!		Return 1 for success, 0 for failure with a message in err.
+//! \param[in]	spec - chain spec.
+//! \param[out]	err  - error message.
+//
+bool
+FilterChain::parse(const std::string &spec, std::string &err)
+{
+	m_steps.clear();
+
+	size_t pos = 0;
+	while(pos <= spec.size()) {
+		// split off next comma-separated token
+		size_t comma = spec.find(',', pos);
+		if(comma == std::string::npos) comma = spec.size();
+		std::string tok = spec.substr(pos, comma - pos);
+		pos = comma + 1;
+		if(tok.empty()) {
+			err = "empty step in filter chain";
+			return 0;
+		}
+
+		// name:arg or bare name starts a new step; anything else is an argument
+		std::string arg;
+		size_t colon = tok.find(':');
+		int type = filterType(tok.substr(0, colon));
+		if(type >= 0) {
+			FilterStep step;
+			step.type = type;
+			m_steps.push_back(step);
+			if(colon == std::string::npos) continue;
+			arg = tok.substr(colon+1);
+		} else if(colon != std::string::npos) {
+			err = "unknown filter '" + tok.substr(0, colon) + "'";
+			return 0;
+		} else if(m_steps.empty()) {
+			err = "unknown filter '" + tok + "'";
+			return 0;
+		} else	arg = tok;
+
+		// key=value or positional argument
+		std::string key, val = arg;
+		size_t eq = arg.find('=');
+		if(eq != std::string::npos) {
+			key = arg.substr(0, eq);
+			val = arg.substr(eq+1);
+		}
+		if(!setArg(m_steps.back(), key, val)) {
+			err = "bad argument '" + arg + "' in filter chain";
+			return 0;
+		}
+	}
+
+	if(m_steps.empty()) {
+		err = "empty filter chain";
+		return 0;
+	}
+	return 1;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// FilterChain::applyStep:
+//
+// Run the kernel of one step on I1; output is in I2.
+// Return 1 for success, 0 for failure.
+//
+bool
+FilterChain::applyStep(const FilterStep &step, ImagePtr I1, ImagePtr I2)
+{
+	// histogram stretching resolves auto values in place; keep the step intact
+	HistogramStretchingParams stretch = step.histogramstretching;
+
+	switch(step.type) {
+	case FilterStep::THRESHOLD:	   return threshold	     (I1, step.threshold,	  I2);
+	case FilterStep::CONTRAST:	   return contrast	     (I1, step.contrast,	  I2);
+	case FilterStep::QUANTIZATION:	   return quantization	     (I1, step.quantization,	  I2);
+	case FilterStep::HISTOGRAMSTRETCHING: return histogramstretching(I1, stretch,		  I2);
+	case FilterStep::HISTOGRAMMATCHING: return histogrammatching (I1, step.histogrammatching, I2);
+	case FilterStep::BLUR:		   return blur		     (I1, step.blur,		  I2);
+	case FilterStep::SHARPEN:	   return sharpen	     (I1, step.sharpen,		  I2);
+	case FilterStep::MEDIAN:	   return median	     (I1, step.median,		  I2);
+	}
+	return 0;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// pointStep:
+//
+// Return 1 if step maps each pixel by a table of its gray level alone,
+// so that it can be fused with neighboring point operations. A stretch
+// with auto ends from the luminance is not: the luminance histogram of
+// its input cannot be told from the channel histograms of I1.
+//
+static bool
+pointStep(const FilterStep &step)
+{
+	const HistogramStretchingParams &stretch = step.histogramstretching;
+	switch(step.type) {
+	case FilterStep::THRESHOLD:
+	case FilterStep::CONTRAST:
+		return 1;
+	case FilterStep::HISTOGRAMSTRETCHING:
+		return stretch.mode != HistogramStretchingParams::LUMA ||
+		      !(stretch.autoMin || stretch.autoMax);
+	case FilterStep::QUANTIZATION:
+		return !step.quantization.dither;
+	}
+	return 0;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// FilterChain::applyPoints:
+//
+//! \brief	Run point operation steps [i0,i1) on I1 in one pass; output is in I2.
+//! \details	The tables of the steps are composed into one per channel. A
+//!		stretch with auto min or max reads them from the histograms of
+//!		its own input, which are those of the channels of I1 mapped
+//!		by their tables so far (and pooled, unless the stretch is per
+//!		channel), so the output matches running the steps one by one.
+//!		Return 1 for success, 0 if any step fails.
+//! \param[in]	i0, i1 - steps to fuse.
+//! \param[in]	I1     - Input image.
+//! \param[out]	I2     - Output image.
+//
+bool
+FilterChain::applyPoints(int i0, int i1, ImagePtr I1, ImagePtr I2) const
+{
+	if(I1.isNull()) return 0;
+
+	// histograms of the channels of I1, scanned only if a stretch needs them
+	int i, ch, nch = I1->maxChannel();
+	std::vector<int> hist, mapped;
+	for(i = i0; i < i1; ++i) {
+		const FilterStep &step = m_steps[i];
+		if(step.type == FilterStep::HISTOGRAMSTRETCHING &&
+		  (step.histogramstretching.autoMin || step.histogramstretching.autoMax)) {
+			hist  .resize((size_t) nch * MXGRAY);
+			mapped.resize((size_t) nch * MXGRAY);
+			histogramChannels(I1, &hist[0]);
+			break;
+		}
+	}
+
+	std::vector<PointLut> luts(nch), next(nch);
+	for(i = i0; i < i1; ++i) {
+		const FilterStep &step = m_steps[i];
+		HistogramStretchingParams stretch = step.histogramstretching;
+		bool ok = 0, each = 0;
+		switch(step.type) {
+		case FilterStep::THRESHOLD:	ok = thresholdLut   (step.threshold,    next[0]); break;
+		case FilterStep::CONTRAST:	ok = contrastLut    (step.contrast,     next[0]); break;
+		case FilterStep::QUANTIZATION:	ok = quantizationLut(step.quantization, next[0]); break;
+		case FilterStep::HISTOGRAMSTRETCHING:
+			if(stretch.autoMin || stretch.autoMax) {
+				for(ch = 0; ch < nch; ch++)
+					luts[ch].mapHistogram(&hist[ch * MXGRAY], &mapped[ch * MXGRAY]);
+				if(stretch.mode != HistogramStretchingParams::CHANNEL)
+					for(ch = 1; ch < nch; ch++)
+						for(int k = 0; k < MXGRAY; ++k)
+							mapped[k] += mapped[ch * MXGRAY + k];
+			}
+			ok = histogramstretchingLuts(stretch, mapped.empty() ? 0 : &mapped[0], nch, &next[0]);
+			each = 1;
+			break;
+		}
+		if(!ok) return 0;
+		for(ch = 0; ch < nch; ch++) luts[ch].then(next[each ? ch : 0]);
+	}
+
+	return pointLut(I1, &luts[0], I2);
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// FilterChain::apply:
+//
+//! \brief	Run all steps in order on I1; output is in I2.
+//! \details	Intermediate results ping-pong between two temporary images.
+//!		Runs of two or more point operations go through applyPoints().
+//!		Return 1 for success, 0 if any step fails.
+//! \param[in]	I1 - Input image.
+//! \param[out]	I2 - Output image.
+//
+bool
+FilterChain::apply(ImagePtr I1, ImagePtr I2) const
+{
+	ImagePtr tmp[2];
+	ImagePtr in = I1;
+	int n = size();
+
+	for(int i = 0, k = 0; i < n; ++k) {
+		// steps [i,j) run as one pass
+		int j = i + 1;
+		if(pointStep(m_steps[i]))
+			while(j < n && pointStep(m_steps[j])) ++j;
+
+		ImagePtr out = (j == n) ? I2 : tmp[k & 1];
+		bool ok = (j - i > 1) ? applyPoints(i, j, in, out)
+				      : applyStep(m_steps[i], in, out);
+		if(!ok) return 0;
+		in = out;
+		i  = j;
+	}
+	return n > 0;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// FilterChain::setBands:
+//
+// Split every blur, sharpen and median step into n bands, as with b=n;
+// kernels cap n at the no. of rows or columns they split.
+//
+void
+FilterChain::setBands(int n)
+{
+	for(size_t i = 0; i < m_steps.size(); ++i) {
+		m_steps[i].blur.bands	 = n;
+		m_steps[i].sharpen.bands = n;
+		m_steps[i].median.bands	 = n;
+	}
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// FilterChain::usage:
+//
+// Help text describing the chain spec syntax.
+//
+const char*
+FilterChain::usage()
+{
+	return
+	"filter chain: comma-separated steps, each name[:args]\n"
+	"  threshold:T                  threshold at T\n"
+	"  contrast:b=B,c=C             brightness B, contrast C (-100..100)\n"
+	"  quantize:L[,dither=1]        L levels, optional dither\n"
+	"  stretch:auto | stretch:min=M,max=N   (min/max may be auto)\n"
+	"  stretch:auto,clip=P          auto min/max skip P percent of pixels at each end\n"
+	"  stretch:auto,m=M             auto min/max from M: pooled (all channels),\n"
+	"                               channel (each its own) or luma (luminance)\n"
+	"  match:N                      match exponential histogram (0: equalize)\n"
+	"  match:ref=FILE               match histogram of image FILE, read once\n"
+	"  blur:WxH[,b=B] | blur:N      box blur in B bands (0: one per pool thread)\n"
+	"  blur:s=S[,p=P]               Gaussian blur of sigma S from P box passes (3-5)\n"
+	"  blur:WxH,sat=1 | blur:WxH,map=FILE   box blur from a summed-area table;\n"
+	"                               any W, H; FILE scales windows per pixel;\n"
+	"                               not with s=S, edges always replicated\n"
+	"  sharpen:N[,f=F,b=B]          unsharp mask of size N, factor F, in B bands\n"
+	"  median:N[,k=K,m=M,b=B]       median of size N, average K neighbors, in B bands;\n"
+	"                               M: auto, huang, constant (time) or\n"
+	"                               network (sorting network, N <= 7)\n"
+	"  blur, sharpen, median also take e=E for pixels past the edges;\n"
+	"                               E: replicate, reflect, wrap or a gray level\n"
+	"consecutive threshold, contrast, quantize (no dither) and stretch steps\n"
+	"run as a single pass over the image, except an auto stretch with m=luma\n";
+}
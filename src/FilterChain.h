@@ -0,0 +1,75 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// FilterChain.h - Sequence of headless filter kernels parsed from a spec
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#ifndef FILTERCHAIN_H
+#define FILTERCHAIN_H
+
+#include <string>
+#include <vector>
+#include "ThresholdKernel.h"
+#include "ContrastKernel.h"
+#include "QuantizationKernel.h"
+#include "HistogramStretchingKernel.h"
+#include "HistogramMatchingKernel.h"
+#include "BlurKernel.h"
+#include "SharpenKernel.h"
+#include "MedianKernel.h"
+
+// ----------------------------------------------------------------------
+// one step of a filter chain: the kernel to run and its parameters
+//
+struct FilterStep {
+	enum {THRESHOLD, CONTRAST, QUANTIZATION, HISTOGRAMSTRETCHING, HISTOGRAMMATCHING,
+	      BLUR, SHARPEN, MEDIAN};
+
+	int				type;		// one of the enums above
+	ThresholdParams			threshold;
+	ContrastParams			contrast;
+	QuantizationParams		quantization;
+	HistogramStretchingParams	histogramstretching;
+	HistogramMatchingParams		histogrammatching;
+	BlurParams			blur;
+	SharpenParams			sharpen;
+	MedianParams			median;
+};
+
+//////////////////////////////////////////////////////////////////////////
+///
+/// \class FilterChain
+/// \brief Filter chain parsed from a spec such as
+///	   "blur:9x9,median:5,contrast:b=10,c=20".
+///
+/// Steps are separated by commas. Each step is name[:args]; arguments
+/// are separated by commas too, and a comma-separated token that is not
+/// a filter name continues the arguments of the previous step.
+///
+/// Consecutive point operations (threshold, contrast, quantization
+/// without dither, histogram stretching) are fused: their lookup
+/// tables are composed and the image is mapped once for the whole run.
+///
+//////////////////////////////////////////////////////////////////////////
+
+class FilterChain {
+public:
+	bool		parse	(const std::string &spec, std::string &err);
+	bool		apply	(ImagePtr I1, ImagePtr I2) const;
+	int		size	() const { return (int) m_steps.size(); }
+	const FilterStep& step	(int i) const { return m_steps[i]; }
+	void		setBands(int n);	// bands of every blur, sharpen and median step
+
+	static bool	applyStep(const FilterStep &, ImagePtr I1, ImagePtr I2);
+	static const char* usage();
+
+private:
+	bool		applyPoints(int i0, int i1, ImagePtr I1, ImagePtr I2) const;
+
+	std::vector<FilterStep>	m_steps;
+};
+
+#endif	// FILTERCHAIN_H
@@ -0,0 +1,447 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// Histogram.cpp - Gray level histograms shared by the kernels and the GUI
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#include "Histogram.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <stdint.h>
+#include <vector>
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// histogramBand:
+//
+//! \brief	Add the gray levels of n pixels to hist.
+//! \details	Runs of equal pixels, common in flat regions, would make each
+//!		increment wait for the store of the previous one to the same
+//!		bin. Pixels are therefore counted round robin into 4 sub-
+//!		histograms, read 8 at a time, and the sub-histograms are
+//!		added up at the end.
+//! \param[in]	src  - pixels.
+//! \param[in]	n    - no. of pixels.
+//! \param[in,out] hist - MXGRAY counts.
+//
+static void
+histogramBand(const uchar *src, long long n, int *hist)
+{
+	int sub[4][MXGRAY];
+	memset(sub, 0, sizeof(sub));
+
+	long long i = 0;
+	for(; i + 8 <= n; i += 8) {
+		uint64_t v;
+		memcpy(&v, src + i, 8);
+		sub[0][ v        & 0xFF]++;
+		sub[1][(v >>  8) & 0xFF]++;
+		sub[2][(v >> 16) & 0xFF]++;
+		sub[3][(v >> 24) & 0xFF]++;
+		sub[0][(v >> 32) & 0xFF]++;
+		sub[1][(v >> 40) & 0xFF]++;
+		sub[2][(v >> 48) & 0xFF]++;
+		sub[3][ v >> 56        ]++;
+	}
+	for(; i < n; ++i) sub[0][src[i]]++;
+
+	for(int k = 0; k < MXGRAY; ++k)
+		hist[k] += sub[0][k] + sub[1][k] + sub[2][k] + sub[3][k];
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// histogramBands:
+//
+//! \brief	Count n pixels into nhist histograms in parallel.
+//! \details	Pixels are split into bands of at least HISTO_BAND pixels,
+//!		one per thread of the global pool. count(i0, i1, bins) adds
+//!		pixels [i0,i1) to nhist*MXGRAY bins of the band's own, which
+//!		are summed in band order at the end.
+//! \param[in]	n     - no. of pixels.
+//! \param[in]	nhist - no. of histograms.
+//! \param[out]	hist  - nhist*MXGRAY counts.
+//! \param[in]	count - counts a range of pixels.
+//
+static void
+histogramBands(long long n, int nhist, int *hist,
+	       const std::function<void(long long, long long, int*)> &count)
+{
+	int size = nhist * MXGRAY;
+	memset(hist, 0, size * sizeof(int));
+
+	int nbands = ThreadPool::global().size();
+	nbands = (int) MAX(1, MIN((long long) nbands, n / HISTO_BAND));
+	if(nbands == 1) {
+		count(0, n, hist);
+		return;
+	}
+
+	std::vector<int> bins((size_t) nbands * size, 0);
+	ThreadPool::global().parallelFor(nbands, [&](int b) {
+		count(n * b / nbands, n * (b+1) / nbands, &bins[(size_t) b * size]);
+	});
+
+	for(int b = 0; b < nbands; ++b)
+		for(int k = 0; k < size; ++k)
+			hist[k] += bins[(size_t) b * size + k];
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// histogramPixels:
+//
+//! \brief	Histogram of n uchar pixels.
+//! \param[in]	src  - pixels.
+//! \param[in]	n    - no. of pixels.
+//! \param[out]	hist - MXGRAY counts.
+//
+void
+histogramPixels(const uchar *src, long long n, int *hist)
+{
+	histogramBands(n, 1, hist, [&](long long i0, long long i1, int *bins) {
+		histogramBand(src + i0, i1 - i0, bins);
+	});
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// histogramChannel:
+//
+// Histogram of channel ch of I, which must be a uchar channel.
+//
+void
+histogramChannel(ImagePtr I, int ch, int *hist)
+{
+	int type;
+	ChannelPtr<uchar> p;
+	if(!IP_getChannel(I, ch, p, type)) {
+		memset(hist, 0, MXGRAY * sizeof(int));
+		return;
+	}
+	histogramPixels(&*p, (long long) I->width() * I->height(), hist);
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// histogramChannels:
+//
+//! \brief	Histograms of all channels of I in one sweep.
+//! \details	Each band is counted in every channel before the next one,
+//!		so a thread reads all planes of its part of the image at once.
+//! \param[in]	I    - image of uchar channels.
+//! \param[out]	hist - MXGRAY counts per channel, channel 0 first.
+//
+void
+histogramChannels(ImagePtr I, int *hist)
+{
+	int type;
+	ChannelPtr<uchar> p;
+	std::vector<const uchar*> planes;
+	for(int ch = 0; IP_getChannel(I, ch, p, type); ch++)
+		planes.push_back(&*p);
+	int nch = (int) planes.size();
+
+	histogramBands((long long) I->width() * I->height(), nch, hist,
+		       [&](long long i0, long long i1, int *bins) {
+		for(int ch = 0; ch < nch; ch++)
+			histogramBand(planes[ch] + i0, i1 - i0, bins + ch * MXGRAY);
+	});
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// histogramPooled:
+//
+// Histogram of the pixels of all channels of I together.
+//
+void
+histogramPooled(ImagePtr I, int *hist)
+{
+	int nch = I->maxChannel();
+	std::vector<int> h((size_t) MAX(nch, 1) * MXGRAY);
+	histogramChannels(I, &h[0]);
+
+	memset(hist, 0, MXGRAY * sizeof(int));
+	for(int ch = 0; ch < nch; ch++)
+		for(int k = 0; k < MXGRAY; ++k) hist[k] += h[ch * MXGRAY + k];
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// histogramLuma:
+//
+//! \brief	Histogram of the luminance of I.
+//! \details	Luminance is (77R + 150G + 29B + 128) / 256, the Rec. 601
+//!		weights in 8 bits, computed a short run of pixels at a time
+//!		and counted like a channel. Images with fewer than 3
+//!		channels use channel 0.
+//! \param[in]	I    - image of uchar channels.
+//! \param[out]	hist - MXGRAY counts.
+//
+void
+histogramLuma(ImagePtr I, int *hist)
+{
+	if(I->maxChannel() < 3) {
+		histogramChannel(I, 0, hist);
+		return;
+	}
+
+	int type;
+	ChannelPtr<uchar> r, g, b;
+	IP_getChannel(I, 0, r, type);
+	IP_getChannel(I, 1, g, type);
+	IP_getChannel(I, 2, b, type);
+	const uchar *pr = &*r, *pg = &*g, *pb = &*b;
+
+	histogramBands((long long) I->width() * I->height(), 1, hist,
+		       [&](long long i0, long long i1, int *bins) {
+		uchar y[8192];
+		for(long long i = i0; i < i1; i += 8192) {
+			int n = (int) MIN(8192LL, i1 - i);
+			for(int x = 0; x < n; ++x)
+				y[x] = (77*pr[i+x] + 150*pg[i+x] + 29*pb[i+x] + 128) >> 8;
+			histogramBand(y, n, bins);
+		}
+	});
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// HistogramStats::HistogramStats:
+//
+//! \brief	Constructor. Statistics of the pixels counted in hist.
+//! \details	An empty histogram has min 0, max MaxGray and mean 0.
+//! \param[in]	hist - MXGRAY counts.
+//
+HistogramStats::HistogramStats(const int *hist)
+	: count(0), min(0), max(MaxGray), mean(0), variance(0)
+{
+	double sum = 0, sum2 = 0;
+	int lo = -1, hi = -1;
+	for(int i = 0; i < MXGRAY; ++i) {
+		if(hist[i]) {
+			if(lo < 0) lo = i;
+			hi = i;
+			sum  += (double) i * hist[i];
+			sum2 += (double) i * i * hist[i];
+		}
+		count += hist[i];
+		cdf[i] = count;
+	}
+	if(!count) return;
+
+	min	 = lo;
+	max	 = hi;
+	mean	 = sum / count;
+	variance = MAX(0., sum2 / count - mean * mean);
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// HistogramStats::percentile:
+//
+//! \brief	Lowest level with more than p percent of the pixels at or
+//!		below it.
+//! \details	percentile(0) is min and percentile(100) is max.
+//! \param[in]	p - percent, 0..100.
+//
+int
+HistogramStats::percentile(double p) const
+{
+	if(p >= 100 || !count) return p < 100 ? min : max;
+
+	// cdf[] is nondecreasing: binary search for the first entry above p%
+	long long target = (long long) floor(MAX(0., p) * count / 100);
+	return (int) (std::upper_bound(cdf, cdf + MXGRAY, target) - cdf);
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// HistogramCache::HistogramCache:
+//
+// Constructor. Empty cache.
+//
+HistogramCache::HistogramCache()
+	: m_clock(0)
+{}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// HistogramCache::global:
+//
+// Cache shared by the GUI; created on first use.
+//
+HistogramCache&
+HistogramCache::global()
+{
+	static HistogramCache cache;
+	return cache;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// HistogramCache::lookup:
+//
+//! \brief	Entry of image I, emptied if I is new or has changed shape.
+//! \details	A new image takes the place of the least recently used one
+//!		when the cache is full. The channel histograms are counted
+//!		here if they are not cached; everything else is summed from
+//!		them. Called with m_mutex held.
+//! \param[in]	I - image.
+//
+HistogramCache::Entry&
+HistogramCache::lookup(ImagePtr I)
+{
+	// channel buffers of I as it is now
+	int type;
+	ChannelPtr<uchar> p;
+	std::vector<const void*> planes;
+	for(int ch = 0; IP_getChannel(I, ch, p, type); ch++)
+		planes.push_back(&*p);
+
+	// find I, else the entry to reuse for it
+	size_t i, k = 0;
+	for(i = 0; i < m_entries.size() && !(m_entries[i].image == I); ++i)
+		if(m_entries[i].used < m_entries[k].used) k = i;
+	if(i == m_entries.size()) {
+		if(i < HISTO_CACHE) m_entries.push_back(Entry());
+		else		    i = k;
+		m_entries[i].image = I;
+		m_entries[i].w	   = -1;
+	}
+
+	Entry &e = m_entries[i];
+	e.used = ++m_clock;
+	if(e.w != I->width() || e.h != I->height() || e.planes != planes) {
+		e.w	 = I->width();
+		e.h	 = I->height();
+		e.planes = planes;
+		e.bins.assign((planes.size() + 2) * MXGRAY, 0);
+		e.valid.assign(3, 0);
+	}
+	if(!e.valid[0] && !planes.empty()) {
+		histogramChannels(I, &e.bins[0]);
+		e.valid[0] = 1;
+	}
+	return e;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// HistogramCache::channel:
+//
+//! \brief	Histogram of channel ch of I, counted only if not cached.
+//! \param[in]	I    - image of uchar channels.
+//! \param[in]	ch   - channel.
+//! \param[out]	hist - MXGRAY counts.
+//
+void
+HistogramCache::channel(ImagePtr I, int ch, int *hist)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Entry &e = lookup(I);
+	if(ch < 0 || ch >= (int) e.planes.size())
+		memset(hist, 0, MXGRAY * sizeof(int));
+	else	memcpy(hist, &e.bins[(size_t) ch * MXGRAY], MXGRAY * sizeof(int));
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// HistogramCache::channels:
+//
+// Histograms of all channels of I, as histogramChannels() returns them.
+//
+void
+HistogramCache::channels(ImagePtr I, int *hist)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Entry &e = lookup(I);
+	memcpy(hist, &e.bins[0], e.planes.size() * MXGRAY * sizeof(int));
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// HistogramCache::pooled:
+//
+//! \brief	Histogram of all channels of I together.
+//! \details	Summed from the cached channel histograms.
+//! \param[in]	I    - image of uchar channels.
+//! \param[out]	hist - MXGRAY counts.
+//
+void
+HistogramCache::pooled(ImagePtr I, int *hist)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Entry &e = lookup(I);
+	int nch = (int) e.planes.size();
+
+	int *sum = &e.bins[(size_t) nch * MXGRAY];
+	if(!e.valid[1]) {
+		memset(sum, 0, MXGRAY * sizeof(int));
+		for(int ch = 0; ch < nch; ch++)
+			for(int k = 0; k < MXGRAY; ++k) sum[k] += e.bins[ch * MXGRAY + k];
+		e.valid[1] = 1;
+	}
+	memcpy(hist, sum, MXGRAY * sizeof(int));
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// HistogramCache::luma:
+//
+// Histogram of the luminance of I, as histogramLuma() returns it.
+//
+void
+HistogramCache::luma(ImagePtr I, int *hist)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Entry &e = lookup(I);
+
+	int *y = &e.bins[(e.planes.size() + 1) * MXGRAY];
+	if(!e.valid[2]) {
+		histogramLuma(I, y);
+		e.valid[2] = 1;
+	}
+	memcpy(hist, y, MXGRAY * sizeof(int));
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// HistogramCache::invalidate:
+//
+// Forget the histograms of I; call after writing its pixels.
+//
+void
+HistogramCache::invalidate(ImagePtr I)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for(size_t i = 0; i < m_entries.size(); ++i)
+		if(m_entries[i].image == I) {
+			m_entries.erase(m_entries.begin() + i);
+			return;
+		}
+}
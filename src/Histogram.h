@@ -0,0 +1,101 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// Histogram.h - Gray level histograms shared by the kernels and the GUI
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include "IP.h"
+#include <vector>
+#include <mutex>
+using namespace IP;
+
+// fewest pixels worth handing to another thread
+#define HISTO_BAND	(64*1024)
+
+// ----------------------------------------------------------------------
+// histograms of uchar pixels; hist[] has MXGRAY entries (per channel
+// for histogramChannels) and is overwritten. The pixels are split into
+// bands counted on the global thread pool, each into its own bins, and
+// the bands are summed at the end, so the result does not depend on the
+// number of threads.
+//
+void	histogramPixels	(const uchar *src, long long n, int *hist);	// n pixels
+void	histogramChannel(ImagePtr I, int ch, int *hist);		// channel ch of I
+void	histogramChannels(ImagePtr I, int *hist);			// each channel of I
+void	histogramPooled	(ImagePtr I, int *hist);			// all channels of I
+void	histogramLuma	(ImagePtr I, int *hist);			// luminance of I
+
+//////////////////////////////////////////////////////////////////////////
+///
+/// \class HistogramStats
+/// \brief Statistics of the pixels counted in a histogram.
+///
+/// Computed in one pass over the MXGRAY bins, so it costs nothing next
+/// to the histogram itself. percentile() looks up the CDF, which lets a
+/// stretch ignore a small fraction of outliers at either end.
+///
+//////////////////////////////////////////////////////////////////////////
+
+class HistogramStats {
+public:
+	HistogramStats	(const int *hist);		// hist has MXGRAY entries
+	int	percentile	(double p) const;	// level at p percent of pixels
+
+	long long	count;		// no. of pixels
+	int		min, max;	// lowest and highest occupied level
+	double		mean;		// mean gray level
+	double		variance;	// variance of the gray levels
+	long long	cdf[MXGRAY];	// no. of pixels at or below each level
+};
+
+// no. of images whose histograms HistogramCache keeps
+#define HISTO_CACHE	4
+
+//////////////////////////////////////////////////////////////////////////
+///
+/// \class HistogramCache
+/// \brief Histograms of recently used images, counted once per write.
+///
+/// An image is identified by its ImagePtr, which the cache holds on to
+/// so that the image cannot be freed and another one take its place.
+/// The IP library does not tell when pixels change, so whoever writes
+/// an image the cache may have seen calls invalidate(); the cache also
+/// counts again by itself if the size or channel buffers have changed.
+/// Histograms are copied out, so the cache may be shared by threads.
+///
+//////////////////////////////////////////////////////////////////////////
+
+class HistogramCache {
+public:
+	HistogramCache	();
+	void	channel		(ImagePtr I, int ch, int *hist);	// channel ch of I
+	void	channels	(ImagePtr I, int *hist);		// each channel of I
+	void	pooled		(ImagePtr I, int *hist);		// all channels of I
+	void	luma		(ImagePtr I, int *hist);		// luminance of I
+	void	invalidate	(ImagePtr I);				// I was written
+
+	static HistogramCache&	global	();	// shared cache used by the GUI
+
+private:
+	struct Entry {
+		ImagePtr		image;		// image counted
+		int			w, h;		// its size then
+		std::vector<const void*> planes;	// its channel buffers then
+		std::vector<int>	bins;		// MXGRAY per channel, pooled, luma
+		std::vector<char>	valid;		// channels, pooled, luma counted
+		unsigned		used;		// m_clock at last lookup
+	};
+	Entry&	lookup		(ImagePtr I);
+
+	std::vector<Entry>	m_entries;	// at most HISTO_CACHE
+	unsigned		m_clock;	// lookup counter for eviction
+	std::mutex		m_mutex;	// guards all of the above
+};
+
+#endif	// HISTOGRAM_H
@@ -9,8 +9,7 @@
 
 #include "MainWindow.h"
 #include "HistogramMatching.h"
-#include <cmath>
-#include <cstdio>
+#include "Histogram.h"
 
 extern MainWindow *g_mainWindowP;
 
@@ -49,10 +48,15 @@ HistogramMatching::applyFilter(ImagePtr I1, ImagePtr I2)
 	// error checking
 	if(n < HMin || n > HMax) return 0;
 
-	// apply filter
-  histogrammatching(I1, n, I2);
+	// match the reference image, if one is loaded and selected
+	HistogramMatchingParams params(n);
+	if(m_checkBoxRef->isChecked())
+		params.reference = m_reference;
 
-	return 1;
+	// apply filter; the histogram of I1 is counted once, not on every tick
+	int hist[MXGRAY];
+	HistogramCache::global().pooled(I1, hist);
+	return histogrammatching(I1, params, I2, hist);
 }
 
 
@@ -88,15 +92,25 @@ HistogramMatching::controlPanel()
 	m_spinBoxN->setMaximum(HMax);
 	m_spinBoxN->setValue  (0);
 
+	// create checkbox to match a reference image instead of n, enabled
+	// once a reference is loaded, and button to load it
+	m_checkBoxRef = new QCheckBox("Reference", m_ctrlGrp);
+	m_checkBoxRef->setEnabled(false);
+	m_buttonRef = new QPushButton("Load...", m_ctrlGrp);
+
 	// init signal/slot connections for HistogramMatching
 	connect(m_sliderN , SIGNAL(valueChanged(int)), this, SLOT(changeN (int)));
 	connect(m_spinBoxN, SIGNAL(valueChanged(int)), this, SLOT(changeN (int)));
+	connect(m_checkBoxRef, SIGNAL(stateChanged(int)), this, SLOT(changeRef(int)));
+	connect(m_buttonRef, SIGNAL(clicked()), this, SLOT(loadRef()));
 
 	// assemble dialog
 	QGridLayout *layout = new QGridLayout;
 	layout->addWidget(  label  , 0, 0);
 	layout->addWidget(m_sliderN , 0, 1);
 	layout->addWidget(m_spinBoxN, 0, 2);
+	layout->addWidget(m_checkBoxRef, 1, 1);
+	layout->addWidget(m_buttonRef  , 1, 2);
 
 	// assign layout to group box
 	m_ctrlGrp->setLayout(layout);
@@ -132,130 +146,46 @@ HistogramMatching::changeN(int n)
 
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-// HistogramMatching::HistogramMatching:
+// HistogramMatching::changeRef:
 //
-// HistogramMatching. Output is in I2.
-//! \brief	Mapping image to specified histogram.
-//! \param[in]	I1  - Input image.
-//! \param[in]	n - n.
-//! \param[out]	I2  - Output image.
+// Slot to switch between the reference image and the target given by n.
 //
 void
-HistogramMatching::histogrammatching(ImagePtr I1, int n, ImagePtr I2)
+HistogramMatching::changeRef(int)
 {
+	// apply filter to source image; save result in destination image
+	applyFilter(g_mainWindowP->imageSrc(), g_mainWindowP->imageDst());
+
+	// display output
+	g_mainWindowP->displayOut();
+}
 
-	int w = I1->width();
-	int h = I1->height();
-	int total = w * h;
-
-	IP_copyImageHeader(I1, I2);
-
-	int left[MXGRAY], right[MXGRAY];
-	int Hsum;
-	double Havg, scale, temp;
-	// output histogram
-	int h1[MXGRAY];
-	// target histogram
-	int h2[MXGRAY];
-
-	// clear histogram h1
-	for (int i = 0; i<MXGRAY; i++)
-	  {h1[i] = 0;}
-
-	// evaluate histogram h1
-	int type;
-	ChannelPtr<uchar> p1, p2, endd; //p1 is a pointer that points to pixel. p1++ is pointing to next pixel
-	 for(int ch = 0; IP_getChannel(I1, ch, p1, type); ch++) {
-	   for(endd = p1 + total; p1<endd; p1++)
-	      { h1[*p1] ++; }
-	 }
-
-		double average =  (double)total / MXGRAY;
-
-		// If n = 0 : histogram equalization
-		if (n == 0) {
-			for (int i = 0; i < MXGRAY - 1; ++i) {
-				h2[i] = (int)average;
-			}
-			h2[MXGRAY - 1] = total - (int) average*(MXGRAY - 1);
-		}
-
-		// if n > 0 exponentially increasing histogram
-		else if (n > 0) {
-			for (int i=Havg = 0; i <MXGRAY; ++i) {
-				temp = ROUND(pow((double) i/MXGRAY, (double) n) * MXGRAY);
-				h2[i] = temp;
-				Havg += h2[i];
-			}
-			scale = (double) total / Havg;
-			if (scale != 1) {
-				for (int i = 0; i < MXGRAY; ++i)
-					h2[i] *= scale;
-			}
-		}
-
-		// if n <0 exponentially decreasing histogram
-		else if (n < 0) {
-			Havg = 0;
-			for (int i =0; i < MXGRAY; ++i) {
-				temp = ROUND(pow(1 - (double) i/MXGRAY, (double) abs(n)) * MXGRAY);
-				h2[i] =  temp;
-				Havg += h2[i];
-			}
-			scale = (double) total / Havg;
-			if (scale != 1) {
-				for (int i = 0; i < MXGRAY; ++i)
-					h2[i] *= scale;
-			}
-		}
-
-		int R = 0;
-		Hsum = 0;
-		int p;
-
-		// evaluate mapping of all input gray levels.
-		// each input gray value maps to an interval of valid output values.
-		// The endpoints of the intervals are left[] and right[]
-		for (int i =0; i < MXGRAY; ++i) {
-			// left end of interval
-			left[i] = R;
-			// cumulative value for interval
-			Hsum += h1[i];
-			// compute width of interval in R and adjust Hsum ad the interval widens
-			while (Hsum > h2[R] && R< (MXGRAY - 1)) {
-				Hsum -= h2[R];
-				R++;
-			}
-			// initializa right end of interval
-			right[i] = R;
-		}
-
-		// clear h1 and reuse it below
-		for (int i =0; i < MXGRAY; ++i) {
-			h1[i] = 0;
-		}
-
-		// visit all input pixels and output the transformed pixel to I2
-		for(int ch = 0; IP_getChannel(I1, ch, p1, type); ch++)
-		{
-			IP_getChannel(I2, ch, p2, type);
-			for(endd = p1 + total; p1<endd; p1++)
-		  {
-		    p = left[*p1];
-		    if (h1[p] < h2[p])
-		      {
-		        *p2++ = p;
-		      }
-
-		    else
-		      {
-		        p = left[*p1] = MIN(p+1, right[*p1]);
-						*p2++ = p;
-		      }
-		    h1[p]++;
-		  }
-		}
- }
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// HistogramMatching::loadRef:
+//
+// Slot to choose a reference image. Its histogram is counted here, once,
+// and kept; the image itself is not.
+//
+void
+HistogramMatching::loadRef()
+{
+	QString file = QFileDialog::getOpenFileName(this,
+				"Open Reference", QString(),
+				"Images (*.jpg *.png *.ppm *.pgm *.bmp);;All files (*)");
+	if(file.isNull()) return;
+
+	HistogramMatchingParams params;
+	if(!histogrammatchingReference(IP_readImage(qPrintable(file)), params)) return;
+	m_reference = params.reference;
+
+	// select the reference; this applies the filter unless already selected
+	m_checkBoxRef->setEnabled(true);
+	if(m_checkBoxRef->isChecked())
+		changeRef(1);
+	else	m_checkBoxRef->setChecked(true);
+}
 
 
 
@@ -13,6 +13,7 @@
 #define HISTOGRAMMATCHING_H
 
 #include "ImageFilter.h"
+#include "HistogramMatchingKernel.h"
 
 class HistogramMatching : public ImageFilter {
 	Q_OBJECT
@@ -23,17 +24,19 @@ public:
 	bool		applyFilter(ImagePtr, ImagePtr);          // apply filter to input to init output
 	void		reset		();		                            // reset parameters
 
-protected:
-	void histogrammatching(ImagePtr I1, int n, ImagePtr I2);
-
 protected slots:
 	void changeN(int);
+	void changeRef(int);
+	void loadRef();
 
 private:
 
 	QSlider		*m_sliderN ;	                         // slider to read n
 	QSpinBox	*m_spinBoxN;                           // spinbox to read n
 	QLabel		*m_label;                              // label n
+	QCheckBox	*m_checkBoxRef;                        // match reference instead of n
+	QPushButton	*m_buttonRef;                          // choose reference image
+	std::vector<int> m_reference;                          // histogram of reference image
 	QGroupBox	*m_ctrlGrp;
 };
 
@@ -0,0 +1,424 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// HistogramMatchingKernel.cpp - Headless histogram matching kernel
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#include "HistogramMatchingKernel.h"
+#include "Histogram.h"
+#include "ThreadPool.h"
+#include <climits>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// referenceTarget:
+//
+//! \brief	Rescale the reference histogram ref to count pixels.
+//! \details	Bin i gets the rescaled cumulative count up to i less that up
+//!		to i-1, so the bins add up to exactly count and keep the
+//!		shape of ref.
+//! \param[in]	ref   - MXGRAY counts of the reference image.
+//! \param[in]	count - no. of pixels to match.
+//! \param[out]	h2    - MXGRAY target counts.
+//
+static void
+referenceTarget(const int *ref, long long count, int *h2)
+{
+	long long total = 0;
+	for (int i = 0; i < MXGRAY; ++i) total += ref[i];
+	if (!total) {
+		// empty reference: flat target
+		for (int i = 0; i < MXGRAY; ++i)
+			h2[i] = (int) (count * (i+1) / MXGRAY - count * i / MXGRAY);
+		return;
+	}
+
+	long long cum = 0, prev = 0;
+	for (int i = 0; i < MXGRAY; ++i) {
+		cum += ref[i];
+		long long next = cum * count / total;
+		h2[i] = (int) (next - prev);
+		prev  = next;
+	}
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// blockCounts:
+//
+//! \brief	Prefix sums of the histograms of the MATCH_BLOCK blocks of I.
+//! \details	Each channel is split into blocks in scan order, channel 0
+//!		first; cum[k*MXGRAY + v] is the no. of pixels of level v in
+//!		blocks before k. Blocks are counted in parallel. The last
+//!		row is the pooled histogram of I.
+//! \param[in]	I   - image of uchar channels.
+//! \param[out]	cum - (no. of blocks + 1) * MXGRAY counts.
+//
+static void
+blockCounts(ImagePtr I, std::vector<int> &cum)
+{
+	int type;
+	ChannelPtr<uchar> p;
+	std::vector<const uchar*> src;
+	for(int ch = 0; IP_getChannel(I, ch, p, type); ch++)
+		src.push_back(&*p);
+	int total   = I->width() * I->height();
+	int bpc	    = (total + MATCH_BLOCK-1) / MATCH_BLOCK;
+	int nblocks = (int) src.size() * bpc;
+
+	cum.assign((size_t) (nblocks+1) * MXGRAY, 0);
+	ThreadPool::global().parallelFor(nblocks, [&](int k) {
+		int x = (k % bpc) * MATCH_BLOCK;
+		histogramPixels(src[k / bpc] + x, MIN(MATCH_BLOCK, total - x),
+				&cum[(size_t) (k+1) * MXGRAY]);
+	});
+	for(int k = 1; k <= nblocks; ++k)
+		for(int v = 0; v < MXGRAY; ++v)
+			cum[(size_t) k * MXGRAY + v] += cum[(size_t) (k-1) * MXGRAY + v];
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// matchBlocks:
+//
+//! \brief	Parallel version of the mapping loop of histogrammatching().
+//! \details	The serial loop visits channel 0, 1, ... in scan order. Level
+//!		v starts at output left[v] and moves up by one, to at most
+//!		right[v], whenever it finds its output full. Outputs strictly
+//!		inside (left[v],right[v]) belong to level v alone, so each
+//!		takes max(h2,1) of its pixels in turn; only when v first
+//!		leaves left[v], which lower levels fill too, depends on the
+//!		order of the pixels. Once that is known for every level, as
+//!		j0[v] pixels of level v before it leaves, the output of a
+//!		pixel follows from its level and its rank within the level.
+//!
+//!		The prefix sums of the block histograms, from blockCounts(),
+//!		give the rank of each level at each block. j0[v] is found
+//!		level by level: a binary search over the blocks for the one
+//!		in which left[v] fills up, and a scan of that block alone.
+//!		Bands of blocks are finally mapped in parallel, each starting
+//!		from the ranks at its first block. The output is the same as
+//!		the serial loop's.
+//!		Return 1 for success.
+//! \param[in]	I1    - Input image.
+//! \param[out]	I2    - Output image, with the header of I1.
+//! \param[in]	cum   - block counts of I1 from blockCounts().
+//! \param[in]	h2    - target histogram.
+//! \param[in]	left  - lowest output of each input level.
+//! \param[in]	right - highest output of each input level.
+//
+static bool
+matchBlocks(ImagePtr I1, ImagePtr I2, const std::vector<int> &cum, const int *h2,
+	    const int *left, const int *right)
+{
+	// channel planes of the input and output, visited in channel order
+	int type;
+	ChannelPtr<uchar> p1, p2;
+	std::vector<const uchar*> src;
+	std::vector<uchar*>	  dst;
+	for(int ch = 0; IP_getChannel(I1, ch, p1, type); ch++) {
+		IP_getChannel(I2, ch, p2, type);
+		src.push_back(&*p1);
+		dst.push_back(&*p2);
+	}
+	int total   = I1->width() * I1->height();
+	int bpc	    = (total + MATCH_BLOCK-1) / MATCH_BLOCK;	// blocks per channel
+	int nblocks = (int) src.size() * bpc;
+
+	// pixels [x, x+n) of channel ch make up block k
+	auto block = [&](int k, int &ch, int &x, int &n) {
+		ch = k / bpc;
+		x  = (k % bpc) * MATCH_BLOCK;
+		n  = MIN(MATCH_BLOCK, total - x);
+	};
+
+	// no. of pixels of each level
+	const int *count = &cum[(size_t) nblocks * MXGRAY];
+
+	// pixels an output strictly inside an interval takes
+	int take[MXGRAY];
+	for(int q = 0; q < MXGRAY; ++q) take[q] = MAX(h2[q], 1);
+
+	// j0[v]:     rank of the pixel of level v that first leaves left[v]
+	// arrive[v]: rank of the pixel of level v that first reaches right[v]
+	const long long Never = LLONG_MAX;
+	long long j0[MXGRAY], arrive[MXGRAY];
+	for(int v = 0; v < MXGRAY; ++v) {
+		int L = left[v], R = right[v];
+		j0[v] = arrive[v] = (L == R) ? 0 : Never;
+		if(L == R || !count[v]) continue;
+
+		// output L is also filled by the levels [d,v) that map to L
+		// alone, and by level u = d-1 once it has reached its right end L
+		int d = v;
+		while(d > 0 && left[d-1] == L && right[d-1] == L) d--;
+		int u = d - 1;
+		long long au = (u >= 0) ? arrive[u] : Never;
+
+		// pixels in output L after the first k blocks, if v has not left
+		auto filled = [&](int k) {
+			const int *c = &cum[(size_t) k * MXGRAY];
+			long long f = c[v];
+			for(int w = d; w < v; ++w) f += c[w];
+			if(u >= 0 && c[u] > au) f += c[u] - au;
+			return f;
+		};
+
+		// first block boundary at which output L is full
+		long long target = h2[L];
+		int lo = 0, hi = nblocks + 1;
+		while(lo < hi) {
+			int mid = (lo + hi) / 2;
+			if(filled(mid) >= target) hi = mid;
+			else			  lo = mid + 1;
+		}
+		if(lo == 0) j0[v] = 0;
+		else if(lo <= nblocks) {
+			// replay block lo-1 up to the pixel at which L is full
+			int ch, x, n;
+			block(lo-1, ch, x, n);
+			const int *c = &cum[(size_t) (lo-1) * MXGRAY];
+			const uchar *s = src[ch] + x;
+			long long f  = filled(lo-1);
+			long long rv = c[v];
+			long long ru = (u >= 0) ? c[u] : 0;
+			for(int i = 0; i < n && f < target; ++i) {
+				int g = s[i];
+				if(g == v)		   { f++; rv++; }
+				else if(g >= d && g < v)   f++;
+				else if(g == u)		   { if(ru++ >= au) f++; }
+			}
+			j0[v] = rv;
+		}
+		if(j0[v] == Never) continue;
+
+		// past left[v], each inner output takes its share, then right[v]
+		arrive[v] = j0[v];
+		for(int q = L+1; q < R; ++q) arrive[v] += take[q];
+	}
+
+	// map bands of consecutive blocks in parallel
+	int nbands = MIN(nblocks, 4 * ThreadPool::global().size());
+	ThreadPool::global().parallelFor(nbands, [&](int b) {
+		int k0 = (int) ((long long) nblocks *  b    / nbands);
+		int k1 = (int) ((long long) nblocks * (b+1) / nbands);
+
+		// state of each level at the first pixel of block k0: rank of
+		// its next pixel, its current output, and the rank at which
+		// that output is left
+		long long rank[MXGRAY], limit[MXGRAY];
+		int out[MXGRAY];
+		auto advance = [&](int v) {
+			int q = ++out[v];
+			limit[v] = (q < right[v]) ? limit[v] + take[q] : Never;
+		};
+		for(int v = 0; v < MXGRAY; ++v) {
+			rank[v]	 = cum[(size_t) k0 * MXGRAY + v];
+			out[v]	 = left[v];
+			limit[v] = (left[v] == right[v]) ? Never : j0[v];
+			while(rank[v] >= limit[v]) advance(v);
+		}
+
+		for(int k = k0; k < k1; ++k) {
+			int ch, x, n;
+			block(k, ch, x, n);
+			const uchar *s = src[ch] + x;
+			uchar	    *t = dst[ch] + x;
+			for(int i = 0; i < n; ++i) {
+				int v = s[i];
+				if(rank[v]++ >= limit[v]) advance(v);
+				t[i] = out[v];
+			}
+		}
+	});
+
+	return 1;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// histogrammatching:
+//
+// HistogramMatching. Output is in I2.
+//! \brief	Mapping image to specified histogram.
+//! \details	hist is the pooled histogram of all channels of I1 if the
+//!		caller keeps it, else 0 to count it here.
+//!		Return 1 for success, 0 for failure.
+//! \param[in]	I1     - Input image.
+//! \param[in]	params - exponent n of the target histogram.
+//! \param[out]	I2     - Output image.
+//! \param[in]	hist   - Pooled histogram of I1, or 0.
+//
+bool
+histogrammatching(ImagePtr I1, const HistogramMatchingParams &params, ImagePtr I2, const int *hist)
+{
+	// error checking
+	if (I1.isNull()) return 0;
+
+	int n = params.n;
+
+	int w = I1->width();
+	int h = I1->height();
+	int total = w * h;
+
+	IP_copyImageHeader(I1, I2);
+
+	int left[MXGRAY], right[MXGRAY];
+	int Hsum;
+	double Havg, scale, temp;
+	// output histogram
+	int h1[MXGRAY];
+	// target histogram
+	int h2[MXGRAY];
+
+	// on more than one thread, the pixels are mapped in parallel bands by
+	// matchBlocks(), which needs the histogram of each block of I1
+	std::vector<int> cum;
+	bool parallel = ThreadPool::global().size() > 1 &&
+			(long long) total * I1->maxChannel() > 2*MATCH_BLOCK;
+	if (parallel) blockCounts(I1, cum);
+
+	// evaluate histogram h1 over all channels
+	if (hist)	   memcpy(h1, hist, sizeof(h1));
+	else if (parallel) memcpy(h1, &cum[cum.size() - MXGRAY], sizeof(h1));
+	else		   histogramPooled(I1, h1);
+
+	int type;
+	ChannelPtr<uchar> p1, p2, endd; //p1 is a pointer that points to pixel. p1++ is pointing to next pixel
+
+	// target histogram h2 of a reference image, rescaled to the pixels of I1
+	if (!params.reference.empty()) {
+		long long count = 0;
+		for (int i = 0; i < MXGRAY; ++i) count += h1[i];
+		referenceTarget(&params.reference[0], count, h2);
+	}
+	else {
+		double average =  (double)total / MXGRAY;
+
+		// If n = 0 : histogram equalization
+		if (n == 0) {
+			for (int i = 0; i < MXGRAY - 1; ++i) {
+				h2[i] = (int)average;
+			}
+			h2[MXGRAY - 1] = total - (int) average*(MXGRAY - 1);
+		}
+
+		// if n > 0 exponentially increasing histogram
+		else if (n > 0) {
+			for (int i=Havg = 0; i <MXGRAY; ++i) {
+				temp = ROUND(pow((double) i/MXGRAY, (double) n) * MXGRAY);
+				h2[i] = temp;
+				Havg += h2[i];
+			}
+			scale = (double) total / Havg;
+			if (scale != 1) {
+				for (int i = 0; i < MXGRAY; ++i)
+					h2[i] *= scale;
+			}
+		}
+
+		// if n <0 exponentially decreasing histogram
+		else if (n < 0) {
+			Havg = 0;
+			for (int i =0; i < MXGRAY; ++i) {
+				temp = ROUND(pow(1 - (double) i/MXGRAY, (double) abs(n)) * MXGRAY);
+				h2[i] =  temp;
+				Havg += h2[i];
+			}
+			scale = (double) total / Havg;
+			if (scale != 1) {
+				for (int i = 0; i < MXGRAY; ++i)
+					h2[i] *= scale;
+			}
+		}
+	}
+
+		int R = 0;
+		Hsum = 0;
+		int p;
+
+		// evaluate mapping of all input gray levels.
+		// each input gray value maps to an interval of valid output values.
+		// The endpoints of the intervals are left[] and right[]
+		for (int i =0; i < MXGRAY; ++i) {
+			// left end of interval
+			left[i] = R;
+			// cumulative value for interval
+			Hsum += h1[i];
+			// compute width of interval in R and adjust Hsum ad the interval widens
+			while (Hsum > h2[R] && R< (MXGRAY - 1)) {
+				Hsum -= h2[R];
+				R++;
+			}
+			// initializa right end of interval
+			right[i] = R;
+		}
+
+		// map bands of the image in parallel; the output is the same
+		// as that of the loop below
+		if (parallel)
+			return matchBlocks(I1, I2, cum, h2, left, right);
+
+		// clear h1 and reuse it below
+		for (int i =0; i < MXGRAY; ++i) {
+			h1[i] = 0;
+		}
+
+		// visit all input pixels and output the transformed pixel to I2
+		for(int ch = 0; IP_getChannel(I1, ch, p1, type); ch++)
+		{
+			IP_getChannel(I2, ch, p2, type);
+			for(endd = p1 + total; p1<endd; p1++)
+		  {
+		    p = left[*p1];
+		    if (h1[p] < h2[p])
+		      {
+		        *p2++ = p;
+		      }
+
+		    else
+		      {
+		        p = left[*p1] = MIN(p+1, right[*p1]);
+						*p2++ = p;
+		      }
+		    h1[p]++;
+		  }
+		}
+
+	return 1;
+ }
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// histogrammatchingReference:
+//
+//! \brief	Make R the target of histogram matching.
+//! \details	Counts the pooled histogram of all channels of R into
+//!		params.reference; histogrammatching() then matches to it
+//!		instead of the shape given by params.n.
+//!		Return 1 for success, 0 if R is null.
+//! \param[in]	R      - Reference image.
+//! \param[out]	params - Matching parameters.
+//
+bool
+histogrammatchingReference(ImagePtr R, HistogramMatchingParams &params)
+{
+	// error checking
+	if (R.isNull()) return 0;
+
+	params.reference.resize(MXGRAY);
+	histogramPooled(R, &params.reference[0]);
+	return 1;
+}
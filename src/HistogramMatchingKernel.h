@@ -0,0 +1,39 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// HistogramMatchingKernel.h - Headless histogram matching kernel
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#ifndef HISTOGRAMMATCHINGKERNEL_H
+#define HISTOGRAMMATCHINGKERNEL_H
+
+#include "IP.h"
+#include <vector>
+using namespace IP;
+
+// ----------------------------------------------------------------------
+// histogram matching parameters; filled in by the HistogramMatching
+// widget or by a batch job. If reference is set, by
+// histogrammatchingReference(), the target is the histogram of that
+// image instead of the shape given by n. It is counted once, so the
+// same params can match any number of frames to it.
+//
+struct HistogramMatchingParams {
+	int	n;		// 0: equalize; >0 increasing, <0 decreasing target histogram
+	std::vector<int> reference;	// MXGRAY pooled counts of a reference image, or empty
+
+	HistogramMatchingParams(int e = 0) : n(e) {}
+};
+
+// pixels per block of the parallel mapping; blocks are counted, and their
+// counts kept, for each gray level
+#define MATCH_BLOCK	(16*1024)
+
+bool	histogrammatching(ImagePtr I1, const HistogramMatchingParams &params, ImagePtr I2,
+			  const int *hist = 0);
+bool	histogrammatchingReference(ImagePtr R, HistogramMatchingParams &params);
+
+#endif	// HISTOGRAMMATCHINGKERNEL_H
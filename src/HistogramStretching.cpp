@@ -10,16 +10,15 @@
 
 #include "MainWindow.h"
 #include "HistogramStretching.h"
+#include "Histogram.h"
 
 extern MainWindow *g_mainWindowP;
 
 
 
 // Min and Max values for sliders
-// initializing Histogram array of 256 entries
 int Min = 0;
 int Max = MaxGray;
-int Histogram[MXGRAY];
 
 
 
@@ -46,81 +45,38 @@ HistogramStretching::applyFilter(ImagePtr I1, ImagePtr I2)
 	// error checking
 	if (I1.isNull()) return 0;
 
-	// initializing min and max values for finding the min and max pixel intensity in the input image
-	int min = 0;
-	int max = MaxGray;
-
-	int w = I1->width();
-	int h = I1->height();
-	int total = w * h;
-
-	// initializing Histogram with all 0 entries
-	int i = 0;
-	for (i = 0; i<MXGRAY; i++)
-	 {Histogram[i] = 0;}
-
-	 // reading input pixels values and storing their frequencies in Histogram
-	 // p1 is a pointer that points to current pixel in I1. p1++ is pointing to next pixel in I1
-   // p2 is a pointer that points to current pixel in I2. p2++ is pointing to next pixel in I2
-	 int type;
-	 ChannelPtr<uchar> p1, p2, endd;
-	 for(int ch = 0; IP_getChannel(I1, ch, p1, type); ch++) {
-		for(endd = p1 + total; p1<endd; p1++)
-	  Histogram[*p1] ++;
-	 }
-
-  // check if auto checkboxes are checked
-  int minautovalue = m_checkBoxMin->isChecked();
-  int maxautovalue = m_checkBoxMax->isChecked();
-
-	// minimum and maximum histogram stretch variables
-  int minstretch, maxstretch;
-
-	// get min and max values from siders
-	minstretch = m_sliderMin->value();
-	maxstretch = m_sliderMax->value();
-
-	// if minautovalue is checked then read minimum pixel intensity from image
-	// reading first non zero value from left of image and copying it to minimum
-	// change values for slider and spinbox to minimum value of image
-	if (minautovalue)
-	{
-		int minimum = min, i =0;
-		for (i=0; i<MXGRAY; i++)
-		{ if (!Histogram[i]) continue;
-				minimum = i;
-				break; }
-		minstretch = minimum;
-		m_sliderMin->setValue (minimum);
-		m_spinBoxMin->setValue (minimum);
+	// get min and max values from sliders and check if auto checkboxes are checked
+	HistogramStretchingParams params;
+	params.min     = m_sliderMin->value();
+	params.max     = m_sliderMax->value();
+	params.autoMin = m_checkBoxMin->isChecked();
+	params.autoMax = m_checkBoxMax->isChecked();
+	params.clip    = m_spinBoxClip->value();
+	params.mode    = m_comboMode->currentIndex();
+
+	// apply filter; the histograms of I1 are counted once, not on every tick
+	std::vector<int> hist((size_t) MAX(I1->maxChannel(), 1) * MXGRAY);
+	if (params.autoMin || params.autoMax) {
+		switch (params.mode) {
+		case HistogramStretchingParams::CHANNEL: HistogramCache::global().channels(I1, &hist[0]); break;
+		case HistogramStretchingParams::LUMA:	 HistogramCache::global().luma	  (I1, &hist[0]); break;
+		default:				 HistogramCache::global().pooled  (I1, &hist[0]); break;
+		}
 	}
+	if (!histogramstretching(I1, params, I2, &hist[0])) return 0;
 
-	// if maxautovalue is checked then read maximum pixel intensity from image
-	// reading first non zero value from right of image and copying it to maximum
-	// change values for slider and spinbox to maximum value of image
-	if (maxautovalue)
+	// if auto values were computed from the image then
+	// change values for slider and spinbox to minimum and maximum value of image
+	if (params.autoMin)
 	{
-		int maximum = MaxGray;
-		int i = 0;
-		for (i=MaxGray; i>= 0; i--)
-		{ if (!Histogram[i]) continue;
-				maximum = i;
-				break; }
-		maxstretch = maximum;
-		m_sliderMax->setValue  (maximum);
-		m_spinBoxMax->setValue (maximum);
+		m_sliderMin->setValue (params.min);
+		m_spinBoxMin->setValue (params.min);
+	}
+	if (params.autoMax)
+	{
+		m_sliderMax->setValue  (params.max);
+		m_spinBoxMax->setValue (params.max);
 	}
-
-	// error checking
-  if ((minstretch < min || minstretch > max) || (maxstretch < min || maxstretch > max)) return 0;
-
-	// checking that minimum value from slider is atleast 1 less than maximum value from slider
-  if (minstretch >= maxstretch)
-     {maxstretch = minstretch + 1;}
-
- 	// minstretch and maxstretch are the minimum or maximum pixel values from either the slider or image appropriately
-	// apply filter
-  histogramstretching(I1, minstretch, maxstretch, I2);
 	return 1;
 }
 
@@ -180,6 +136,23 @@ HistogramStretching::controlPanel()
 	// create Maxautovalue checkbox
 	m_checkBoxMax = new QCheckBox(m_ctrlGrp);
 
+	// create label and spinbox for the percent of pixels clipped at auto ends
+	QLabel *labelClip = new QLabel;
+	labelClip->setText(QString("Clip %"));
+	m_spinBoxClip = new QDoubleSpinBox(m_ctrlGrp);
+	m_spinBoxClip->setRange     (0, 25);
+	m_spinBoxClip->setSingleStep(0.5);
+	m_spinBoxClip->setValue     (0);
+
+	// create combo box for the histogram the auto ends are read from;
+	// items are in the order of HistogramStretchingParams::POOLED, ...
+	QLabel *labelMode = new QLabel;
+	labelMode->setText(QString("Auto from"));
+	m_comboMode = new QComboBox(m_ctrlGrp);
+	m_comboMode->addItem("All channels");
+	m_comboMode->addItem("Each channel");
+	m_comboMode->addItem("Luminance");
+
 	// init signal/slot connections for Min
 	connect(m_sliderMin , SIGNAL(valueChanged(int)), this, SLOT(changeMin (int)));
 	connect(m_spinBoxMin, SIGNAL(valueChanged(int)), this, SLOT(changeMin (int)));
@@ -189,6 +162,8 @@ HistogramStretching::controlPanel()
 	connect(m_sliderMax , SIGNAL(valueChanged(int)), this, SLOT(changeMax (int)));
 	connect(m_spinBoxMax, SIGNAL(valueChanged(int)), this, SLOT(changeMax (int)));
 	connect(m_checkBoxMax, SIGNAL(stateChanged(int)), this, SLOT(changeMax (int)));
+	connect(m_spinBoxClip, SIGNAL(valueChanged(double)), this, SLOT(changeClip(double)));
+	connect(m_comboMode, SIGNAL(currentIndexChanged(int)), this, SLOT(changeMode(int)));
 
 	//assemble dialog
 	QGridLayout *layout = new QGridLayout;
@@ -200,6 +175,10 @@ HistogramStretching::controlPanel()
 	layout->addWidget(m_sliderMax , 1, 1);
 	layout->addWidget(m_checkBoxMax, 1, 3);
 	layout->addWidget(m_spinBoxMax, 1, 2);
+	layout->addWidget(	labelClip		, 2, 0);
+	layout->addWidget(m_spinBoxClip, 2, 2);
+	layout->addWidget(	labelMode		, 3, 0);
+	layout->addWidget(m_comboMode, 3, 1, 1, 2);
 
 	//assign layout to group box
 	m_ctrlGrp->setLayout(layout);
@@ -259,46 +238,38 @@ HistogramStretching::changeMax(int m)
 
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-// HistogramStretching::histogramstretching:
+// HistogramStretching::changeClip
 //
-// HistogramStretching I1 using the 2-level mapping shown below.  Output is in I2.
-//! \brief	Mapping min-max to 0-255
-//! \param[in]	I1  - Input image.
-//! \param[in]	min - Minimum.
-//! \param[in]	max - Maximum.
-//! \param[out]	I2  - Output image.
+// Slot to process change in the percent of pixels clipped at auto ends.
 //
 void
-HistogramStretching::histogramstretching(ImagePtr I1, int min, int max, ImagePtr I2)
+HistogramStretching::changeClip(double)
 {
-	IP_copyImageHeader(I1, I2);
-	int w = I1->width();
-	int h = I1->height();
-	int total = w * h;
-
-	// compute lut[]
-	// initialized lut of 256 entries
-	// 1. subtract min from every pixel
-	// 2. scale to [0, 1]
-	// 3. map to [0, 255] range
-	int i;
-	for(i=0; i<MXGRAY; ++i)
-	{Histogram[i] = CLIP((int)(MaxGray*(i- min)) / (max - min), 0, MaxGray) ;}
-
-
-	// for each pixel intensity in I1, read its coresponding value from Histogram, and output it to I2
-	// p1 is a pointer that points to current pixel in I1. p1++ is pointing to next pixel in I1
-	// p2 is a pointer that points to current pixel in I2. p2++ is pointing to next pixel in I2
-	int type;
-	ChannelPtr<uchar> p1, p2, endd;
-	for(int ch = 0; IP_getChannel(I1, ch, p1, type); ch++) {
-		IP_getChannel(I2, ch, p2, type);
-		for(endd = p1 + total; p1<endd;) *p2++ = Histogram[*p1++];
-		}
+	// apply filter to source image; save result in destination image
+	applyFilter(g_mainWindowP->imageSrc(), g_mainWindowP->imageDst());
+
+	// display output
+	g_mainWindowP->displayOut();
 }
 
 
 
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// HistogramStretching::changeMode
+//
+// Slot to process change in the histogram the auto ends are read from.
+//
+void
+HistogramStretching::changeMode(int)
+{
+	// apply filter to source image; save result in destination image
+	applyFilter(g_mainWindowP->imageSrc(), g_mainWindowP->imageDst());
+
+	// display output
+	g_mainWindowP->displayOut();
+}
+
+
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // HistogramStretching::reset:
@@ -13,6 +13,7 @@
 #define HISTOGRAMSTRETCHING_H
 
 #include "ImageFilter.h"
+#include "HistogramStretchingKernel.h"
 
 class HistogramStretching : public ImageFilter {
 	Q_OBJECT
@@ -23,12 +24,11 @@ public:
 	bool		applyFilter(ImagePtr, ImagePtr);    // apply filter to input to init output
 	void		reset		();		                      // reset parameters
 
-protected:
-	void histogramstretching(ImagePtr I1, int min, int max, ImagePtr I2);
-
 protected slots:
   void    changeMin (int);
   void    changeMax (int);
+  void    changeClip(double);
+  void    changeMode(int);
 
 private:
 	// histogramstretching controls
@@ -38,6 +38,8 @@ private:
 	QSpinBox	*m_spinBoxMax;	// Max spinbox
 	QCheckBox	*m_checkBoxMin;	// Minautovalue checkbox
   QCheckBox	*m_checkBoxMax;	// Maxautovalue checkbox
+	QDoubleSpinBox	*m_spinBoxClip;	// percent clipped at auto ends
+	QComboBox	*m_comboMode;	// histogram of the auto ends
 
 	// labels for histogramstretching
 	QLabel		*m_labelMin;    // Min label
@@ -0,0 +1,150 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// HistogramStretchingKernel.cpp - Headless histogram stretching kernel
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#include "HistogramStretchingKernel.h"
+#include "Histogram.h"
+#include <vector>
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// histogramstretching:
+//
+// HistogramStretching I1 using the 2-level mapping shown below.  Output is in I2.
+//! \brief	Mapping min-max to 0-255
+//! \details	Auto min/max are resolved from the histogram params.mode
+//!		asks for and written back into params. A caller that keeps
+//!		that histogram passes it in hist; else it is counted here,
+//!		all channels in one sweep. The image is then mapped in one
+//!		pass, each channel by its own table.
+//!		Return 1 for success, 0 for failure.
+//! \param[in]	I1     - Input image.
+//! \param[in,out] params - Minimum, maximum, auto flags and mode.
+//! \param[out]	I2     - Output image.
+//! \param[in]	hist   - Histogram of I1 for params.mode (MXGRAY per
+//!			 channel for CHANNEL), or 0.
+//
+bool
+histogramstretching(ImagePtr I1, HistogramStretchingParams &params, ImagePtr I2, const int *hist)
+{
+	// error checking
+	if (I1.isNull()) return 0;
+
+	// histogram for the mode, only needed for auto min/max
+	int nch = I1->maxChannel();
+	std::vector<int> Histogram;
+	if (!hist && (params.autoMin || params.autoMax)) {
+		Histogram.resize((size_t) MAX(nch, 1) * MXGRAY);
+		switch (params.mode) {
+		case HistogramStretchingParams::CHANNEL: histogramChannels(I1, &Histogram[0]); break;
+		case HistogramStretchingParams::LUMA:	 histogramLuma	  (I1, &Histogram[0]); break;
+		default:				 histogramPooled  (I1, &Histogram[0]); break;
+		}
+		hist = &Histogram[0];
+	}
+
+	std::vector<PointLut> luts(MAX(nch, 1));
+	if (!histogramstretchingLuts(params, hist, nch, &luts[0])) return 0;
+
+	// for each pixel intensity in I1, read its coresponding value from its
+	// channel's lut, and output it to I2
+	return pointLut(I1, &luts[0], I2);
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// histogramstretchingLut:
+//
+//! \brief	Fill lut with the stretch of min-max to 0-255.
+//! \details	For histogramstretching() or a fused chain. Auto min/max are
+//!		the params.clip and 100 - params.clip percentiles of hist,
+//!		and are written back into params.
+//!		Return 1 for success, 0 for min or max out of range.
+//! \param[in,out] params - Minimum, maximum and auto flags.
+//! \param[in]	hist   - pooled histogram of the input; only read for auto
+//!			 min/max.
+//! \param[out]	lut    - stretch mapping.
+//
+bool
+histogramstretchingLut(HistogramStretchingParams &params, const int *hist, PointLut &lut)
+{
+	// initializing min and max values for finding the min and max pixel intensity in the input image
+	int min = 0;
+	int max = MaxGray;
+	int i;
+
+	// if autoMin (autoMax) is set then read the minimum (maximum) from the
+	// image, skipping the darkest (brightest) clip percent of its pixels;
+	// with no clipping these are the lowest and highest occupied levels
+	if (params.autoMin || params.autoMax)
+	{
+		HistogramStats stats(hist);
+		if (params.autoMin) params.min = stats.percentile(params.clip);
+		if (params.autoMax) params.max = stats.percentile(100 - params.clip);
+	}
+
+	// minstretch and maxstretch are the minimum or maximum pixel values from either the params or image appropriately
+	int minstretch = params.min;
+	int maxstretch = params.max;
+
+	// error checking
+	if ((minstretch < min || minstretch > max) || (maxstretch < min || maxstretch > max)) return 0;
+
+	// checking that minimum value is atleast 1 less than maximum value
+	if (minstretch >= maxstretch)
+		{maxstretch = minstretch + 1;}
+
+	// compute lut[]
+	// 1. subtract min from every pixel
+	// 2. scale to [0, 1]
+	// 3. map to [0, 255] range
+	for(i=0; i<MXGRAY; ++i)
+	{lut.map[i] = CLIP((int)(MaxGray*(i- minstretch)) / (maxstretch - minstretch), 0, MaxGray) ;}
+
+	return 1;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// histogramstretchingLuts:
+//
+//! \brief	Fill luts[ch] with the stretch of channel ch.
+//! \details	In CHANNEL mode each channel is stretched by its own
+//!		histogram, and the lowest auto min and highest auto max are
+//!		written back into params. Otherwise all channels share the
+//!		table of histogramstretchingLut().
+//!		Return 1 for success, 0 for min or max out of range.
+//! \param[in,out] params - Minimum, maximum, auto flags and mode.
+//! \param[in]	hist   - histogram for params.mode, MXGRAY per channel
+//!			 for CHANNEL; only read for auto min/max.
+//! \param[in]	nch    - no. of channels.
+//! \param[out]	luts   - nch stretch mappings.
+//
+bool
+histogramstretchingLuts(HistogramStretchingParams &params, const int *hist, int nch, PointLut *luts)
+{
+	if (params.mode != HistogramStretchingParams::CHANNEL || nch < 2) {
+		if (!histogramstretchingLut(params, hist, luts[0])) return 0;
+		for (int ch = 1; ch < nch; ch++) luts[ch] = luts[0];
+		return 1;
+	}
+
+	int lo = MaxGray, hi = 0;
+	for (int ch = 0; ch < nch; ch++) {
+		HistogramStretchingParams p = params;
+		if (!histogramstretchingLut(p, hist ? hist + ch*MXGRAY : 0, luts[ch])) return 0;
+		lo = MIN(lo, p.min);
+		hi = MAX(hi, p.max);
+	}
+	if (params.autoMin) params.min = lo;
+	if (params.autoMax) params.max = hi;
+	return 1;
+}
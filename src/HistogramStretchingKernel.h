@@ -0,0 +1,48 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// HistogramStretchingKernel.h - Headless histogram stretching kernel
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#ifndef HISTOGRAMSTRETCHINGKERNEL_H
+#define HISTOGRAMSTRETCHINGKERNEL_H
+
+#include "IP.h"
+#include "PointLut.h"
+using namespace IP;
+
+// ----------------------------------------------------------------------
+// histogram stretching parameters; filled in by the HistogramStretching
+// widget or by a batch job. If autoMin (autoMax) is set, the kernel reads
+// the minimum (maximum) from the image and writes it back into min (max).
+// A nonzero clip ignores that percent of the pixels at each auto end.
+// mode picks the histogram auto ends are read from: all channels pooled
+// into one, each channel its own (a separate stretch per channel, and
+// the lowest min and highest max are written back), or the luminance,
+// which stretches all channels alike and so keeps their balance.
+//
+struct HistogramStretchingParams {
+	enum {POOLED, CHANNEL, LUMA};
+
+	int	min;		// input level mapped to 0
+	int	max;		// input level mapped to MaxGray
+	int	autoMin;	// take min from the image (0 or 1)
+	int	autoMax;	// take max from the image (0 or 1)
+	double	clip;		// percent of pixels past each auto end (0..50)
+	int	mode;		// POOLED, CHANNEL or LUMA
+
+	HistogramStretchingParams(int lo = 0, int hi = MaxGray, int alo = 0, int ahi = 0,
+				  double c = 0, int m = POOLED)
+		: min(lo), max(hi), autoMin(alo), autoMax(ahi), clip(c), mode(m) {}
+};
+
+bool	histogramstretching(ImagePtr I1, HistogramStretchingParams &params, ImagePtr I2,
+			    const int *hist = 0);
+bool	histogramstretchingLut(HistogramStretchingParams &params, const int *hist, PointLut &lut);
+bool	histogramstretchingLuts(HistogramStretchingParams &params, const int *hist, int nch,
+				PointLut *luts);
+
+#endif	// HISTOGRAMSTRETCHINGKERNEL_H
@@ -0,0 +1,50 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// IntegralImage.cpp - Summed-area tables for O(1) rectangular window sums
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#include "IntegralImage.h"
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// IntegralImage::build:
+//
+//! \brief	Tabulate the summed-area table of a channel.
+//! \details	Each table row is the row above plus the running sum of the
+//!		corresponding image row, so the channel is read once, in order.
+//! \param[in]	src - first pixel of the channel.
+//! \param[in]	w   - channel width.
+//! \param[in]	h   - channel height.
+//
+template <class A>
+template <class T>
+void
+IntegralImage<A>::build(const T *src, int w, int h)
+{
+	m_width  = w;
+	m_height = h;
+	m_table.assign((size_t) (w+1) * (h+1), A(0));
+
+	A *above = &m_table[0];
+	for(int y = 0; y < h; ++y, src += w) {
+		A *t = above + (w+1);
+		A  row = 0;
+		for(int x = 0; x < w; ++x) {
+			row   += src[x];
+			t[x+1] = above[x+1] + row;
+		}
+		above = t;
+	}
+}
+
+
+
+// the accumulator/pixel pairs in use
+template void IntegralImage<uint32_t>::build<uint8_t>(const uint8_t *, int, int);
+template void IntegralImage<uint64_t>::build<uint8_t>(const uint8_t *, int, int);
+template void IntegralImage<double>  ::build<float>(const float *, int, int);
@@ -0,0 +1,105 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// IntegralImage.h - Summed-area tables for O(1) rectangular window sums
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#ifndef INTEGRALIMAGE_H
+#define INTEGRALIMAGE_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+// true if a uchar image of w x h pixels needs 64-bit table entries;
+// 32 bits hold the sum of the whole image up to 16.8 MP
+inline bool	integralWide(int w, int h)
+		{ return 255.0 * w * h > 4294967295.0; }
+
+//////////////////////////////////////////////////////////////////////////
+///
+/// \class IntegralImage
+/// \brief Summed-area table of one channel.
+///
+/// Entry (x,y) holds the sum of all pixels above and to the left of
+/// pixel (x,y), so the table is (w+1) x (h+1) with a zero first row
+/// and column. Once built, the sum over any rectangle costs 4 lookups
+/// regardless of its size.
+///
+/// A is the accumulator: uint32_t or uint64_t for uchar channels (see
+/// integralWide), double for float channels.
+///
+//////////////////////////////////////////////////////////////////////////
+
+template <class A>
+class IntegralImage {
+public:
+	IntegralImage	() : m_width(0), m_height(0) {}
+
+	template <class T>
+	void	build	(const T *src, int w, int h);	// tabulate a w x h channel
+	int	width	() const { return m_width;  }
+	int	height	() const { return m_height; }
+
+	// sum of pixels in [x0,x1) x [y0,y1); the rectangle must lie in the image
+	A	sum	(int x0, int y0, int x1, int y1) const {
+		const A *t0 = &m_table[(size_t) y0 * (m_width+1)];
+		const A *t1 = &m_table[(size_t) y1 * (m_width+1)];
+		return t1[x1] - t1[x0] - t0[x1] + t0[x0];
+	}
+
+	// same, but the rectangle may extend past the image,
+	// whose border pixels are then replicated outward
+	A	sumReplicate(int x0, int y0, int x1, int y1) const;
+
+private:
+	int		m_width;	// channel width
+	int		m_height;	// channel height
+	std::vector<A>	m_table;	// (w+1) x (h+1) entries, row by row
+};
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// IntegralImage::sumReplicate:
+//
+// Pixels past an edge repeat the edge pixel, so the part of the window
+// hanging over the left edge adds lx copies of the clipped column 0,
+// and likewise for the other edges; the four corner regions add copies
+// of the corner pixels. Windows inside the image take the fast path.
+//
+template <class A>
+A
+IntegralImage<A>::sumReplicate(int x0, int y0, int x1, int y1) const
+{
+	int w = m_width;
+	int h = m_height;
+	if(x0 >= 0 && y0 >= 0 && x1 <= w && y1 <= h)
+		return sum(x0, y0, x1, y1);
+
+	// overhang on each side
+	A lx = x0 < 0 ? -x0    : 0;
+	A rx = x1 > w ?  x1-w  : 0;
+	A ty = y0 < 0 ? -y0    : 0;
+	A by = y1 > h ?  y1-h  : 0;
+
+	// window clipped to the image
+	int cx0 = x0 < 0 ? 0 : x0, cx1 = x1 > w ? w : x1;
+	int cy0 = y0 < 0 ? 0 : y0, cy1 = y1 > h ? h : y1;
+
+	A s = sum(cx0, cy0, cx1, cy1);
+	if(lx) s += lx * sum(0,   cy0, 1, cy1);
+	if(rx) s += rx * sum(w-1, cy0, w, cy1);
+	if(ty) s += ty * sum(cx0, 0,   cx1, 1);
+	if(by) s += by * sum(cx0, h-1, cx1, h);
+	if(lx && ty) s += lx * ty * sum(0,   0,   1, 1);
+	if(rx && ty) s += rx * ty * sum(w-1, 0,   w, 1);
+	if(lx && by) s += lx * by * sum(0,   h-1, 1, h);
+	if(rx && by) s += rx * by * sum(w-1, h-1, w, h);
+	return s;
+}
+
+#endif	// INTEGRALIMAGE_H
@@ -17,6 +17,7 @@
 #include "Blur.h"
 #include "Sharpen.h"
 #include "Median.h"
+#include "Histogram.h"
 
 using namespace IP;
 
@@ -475,6 +476,7 @@ MainWindow::open() {
 	if(m_radioMode[1]->isChecked())
 		IP_castImage(m_imageIn,  BW_IMAGE, m_imageSrc);
 	else	IP_castImage(m_imageIn, RGB_IMAGE, m_imageSrc);
+	HistogramCache::global().invalidate(m_imageSrc);
 
 	// init vars
 	m_width  = m_imageSrc->width ();
@@ -559,15 +561,29 @@ void MainWindow::displayHistogram(ImagePtr I)
 	int yminHisto=0,   ymaxHisto=0;
 	int xmin, xmax;
 	QVector<double> x, y;
-	char buf[MXSTRLEN];
+	char buf[MXSTRLEN], stats[MXSTRLEN];
 
 	// clear any previous histogram plots
 	m_histogram->clearGraphs();
 
 	// visit all selected channels in I: RGB, R, G, B, or gray
 	for(int ch=0; ch<I->maxChannel(); ch++) {
-		// compute histogram
-		IP_histogram(I, ch, histo, MXGRAY, m_histoXmin[ch], m_histoXmax[ch]);
+		// compute histogram; uchar channels are counted in parallel and
+		// their range, mean and standard deviation come from its
+		// statistics. The input only changes on open() and mode(), so
+		// its histogram is cached
+		int type;
+		ChannelPtr<uchar> p;
+		stats[0] = 0;
+		if(IP_getChannel(I, ch, p, type) && type == UCHAR_TYPE) {
+			if(I == m_imageSrc)
+				HistogramCache::global().channel(I, ch, histo);
+			else	histogramChannel(I, ch, histo);
+			HistogramStats s(histo);
+			m_histoXmin[ch] = s.min;
+			m_histoXmax[ch] = s.max;
+			sprintf(stats, " M=%.1f SD=%.1f", s.mean, sqrt(s.variance));
+		} else	IP_histogram(I, ch, histo, MXGRAY, m_histoXmin[ch], m_histoXmax[ch]);
 
 		// init min and max for current channel
 		yminChannel = ymaxChannel = histo[0];
@@ -629,6 +645,10 @@ void MainWindow::displayHistogram(ImagePtr I)
 			break;
 		}
 
+		// append mean and standard deviation, if known
+		if(stats[0])
+			m_histogram->graph(ch)->setName(QString(buf) + stats);
+
 		// set data
 		m_histogram->graph(ch)->setData(x,y);
 
@@ -682,6 +702,7 @@ void MainWindow::mode(int flag)
 	if(flag)
 		IP_castImage(m_imageIn,  BW_IMAGE, m_imageSrc);
 	else	IP_castImage(m_imageIn, RGB_IMAGE, m_imageSrc);
+	HistogramCache::global().invalidate(m_imageSrc);
 
 	if(m_imageSrc->imageType() == BW_IMAGE)
 		m_histoColor = GRAY;	// gray
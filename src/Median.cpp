@@ -56,9 +56,10 @@ Median::applyFilter(ImagePtr I1, ImagePtr I2)
 	if (size < s_minkernel || size > s_maxkernel || avg_nbrs < 0 || avg_nbrs > max_avg_nbrs)
 		return 0;
 
-	median (I1, size, avg_nbrs, I2);
+	// combo box entries are in MEDIAN_AUTO, MEDIAN_HUANG, MEDIAN_CONSTANT, MEDIAN_NETWORK order
+	int method = m_comboMethod->currentIndex();
 
-	return 1;
+	return median(I1, MedianParams(size, avg_nbrs, method), I2);
 }
 
 
@@ -115,6 +116,14 @@ Median::controlPanel()
   m_spinBoxavg->setMaximum(s_maxkernel);
   m_spinBoxavg->setValue  (s_minkernel);
 
+	// create combo box for algorithm
+	QLabel *methodlabel = new QLabel;
+	methodlabel->setText(QString("Method"));
+	m_comboMethod = new QComboBox(m_ctrlGrp);
+	m_comboMethod->addItem("Auto");
+	m_comboMethod->addItem("Huang");
+	m_comboMethod->addItem("Constant time");
+	m_comboMethod->addItem("Sorting network");
 
 	// init signal/slot connections for kernel size
 	connect(m_slidersz , SIGNAL(valueChanged(int)), this, SLOT(changeSize (int)));
@@ -124,6 +133,9 @@ Median::controlPanel()
   connect(m_slideravg , SIGNAL(valueChanged(int)), this, SLOT(changeAvg_nbrs (int)));
   connect(m_spinBoxavg, SIGNAL(valueChanged(int)), this, SLOT(changeAvg_nbrs (int)));
 
+	// init signal/slot connections for algorithm
+	connect(m_comboMethod, SIGNAL(currentIndexChanged(int)), this, SLOT(changeMethod (int)));
+
 	// assemble dialog
   QGridLayout *layout = new QGridLayout;
   layout->addWidget(	szlabel	, 0, 0);
@@ -132,6 +144,8 @@ Median::controlPanel()
   layout->addWidget(m_spinBoxsz, 0, 2);
   layout->addWidget(m_slideravg , 1, 1);
   layout->addWidget(m_spinBoxavg, 1, 2);
+	layout->addWidget(methodlabel  , 2, 0);
+	layout->addWidget(m_comboMethod, 2, 1);
 
 	// assign layout to group box
 	m_ctrlGrp->setLayout(layout);
@@ -197,86 +211,18 @@ Median::changeAvg_nbrs(int value)
 
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-// Median::median:
+// Median::changeMethod:
 //
-//! \brief
-//! \details
-//! \param[in]	I1  - Input image.
-//! \param[in]	sz - kernel size.
-//! \param[in]	avg_nbrs - average neighbors to blur with
-//! \param[out]	I2  - Output image.
+// Slot to process change in median algorithm
 //
 void
-Median::median(ImagePtr I1, int sz, int avg_nbrs, ImagePtr I2) {
-
-	int w = I1->width();
-	int h = I1->height();
-	int total = w * h;
-	int mid = ((sz*sz) / 2) + 1;
-
-	int i, x, y, xx, yy, t, sum, ww = 0;
-
-	IP_copyImageHeader(I1, I2);
-
-	// p is temporary uchar type to hold uchar pixel values
-	// p1 is initially first pixel in I1
-	ChannelPtr<uchar> p1, p2, p;
-	for(int ch = 0; IP_getChannel(I1, ch, p1, t); ch++) {
-		IP_getChannel(I2, ch, p2, t);
-
-	int Histogram[MXGRAY];
-
-	// process each row
-	for (y =0; y<h; ++y) {
-
-		//initialize histo with 0's
-		for (int k = 0; k<MXGRAY; k++)
-			{Histogram[k] = 0;}
-
-		// fill kernel
-		for (yy = 0; yy<sz; yy++) {
-
-			// p is the pixel to read
-			// p is the pixel intensity we read. Increase frequency of p in Histogram by 1.
-			// p = 0 on first turn
-			p = p1 + (yy * w);
-
-			// add values to histogram.
-			for (xx = 0; xx<sz; ++xx) {
-				Histogram[*p++]++;
-			}
-	 	}
-
-		//process remaining points in that row
-		for (x=0; x<w; ++x) {
-			//find median
-			for (i=sum=0; i<MXGRAY; ++i) {
-				sum += Histogram[i];
-				if (sum >= mid)
-					break;
-			}
-			//copy median (i) into output
-			*p2++ = i;
-
-			//decrement
-			p = p1 + x;
-			for (yy = 0; yy < sz; yy++) {
-				Histogram[*p]--;
-				p += ww;
-			}
-
-			//increment
-			p = p1 + x + sz;
-			for (yy = 0; yy < sz; yy++) {
-				Histogram[*p]++;
-				p += w;
-			}
-		}
-
-		p1 += ww;
-		}
-	 }
+Median::changeMethod(int)
+{
+	// apply filter to source image; save result in destination image
+	applyFilter(g_mainWindowP->imageSrc(), g_mainWindowP->imageDst());
 
+	// display output
+	g_mainWindowP->displayOut();
 }
 
 
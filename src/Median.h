@@ -11,6 +11,7 @@
 #define MEDIAN_H
 
 #include "ImageFilter.h"
+#include "MedianKernel.h"
 
 class Median : public ImageFilter {
 	Q_OBJECT
@@ -21,12 +22,10 @@ public:
 	bool		applyFilter(ImagePtr, ImagePtr);       // apply filter to input to init output
 	void		reset		();		                         // reset parameters
 
-protected:
-	void median(ImagePtr I1, int sz, int avg_nbrs, ImagePtr I2);
-
 protected slots:
 	void    changeSize (int);
 	void    changeAvg_nbrs (int);
+	void    changeMethod (int);
 
 private:
 	// median controls
@@ -36,6 +35,7 @@ private:
 	QSpinBox	*m_spinBoxavg;	                    // spin box for no. of neighborhoods to average
 	QLabel		*szlabel;
 	QLabel		*avglabel;
+	QComboBox	*m_comboMethod;	                    // median algorithm
 
 	// widgets and groupbox
 	QGroupBox	*m_ctrlGrp;	// groupbox for panel
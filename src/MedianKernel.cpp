@@ -0,0 +1,649 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// MedianKernel.cpp - Headless median filter kernel
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#include "MedianKernel.h"
+#include "ThreadPool.h"
+#include "Scratch.h"
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#define MEDIAN_SSE2
+#include <emmintrin.h>
+#endif
+
+static void medianHuang	 (const uchar *src, uchar *dst, int w, int h, int sz, int k, const Border &b, int y0, int y1);
+static void medianConstant(const uchar *src, uchar *dst, int w, int h, int sz, int k, const Border &b, int y0, int y1);
+static bool medianNetwork (const uchar *src, uchar *dst, int w, int h, int sz, const Border &b, int y0, int y1);
+
+// largest kernel with a sorting network median
+#define MEDIAN_NETWORK_MAX	7
+
+// smallest kernel for which MEDIAN_AUTO picks the constant-time algorithm
+#define MEDIAN_CONSTANT_MIN	9
+
+// two-level histograms of the constant-time median:
+// MEDIAN_COARSE bins of MEDIAN_FINE gray levels each
+#define MEDIAN_FINE	16
+#define MEDIAN_COARSE	(MXGRAY / MEDIAN_FINE)
+
+// largest kernel whose counts fit in the uint16_t bins
+#define MEDIAN_CONSTANT_MAX	255
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// median:
+//
+//! \brief	Replace each pixel by the median of its sz x sz neighborhood.
+//! \details	params.method selects Huang's sliding histogram, whose cost
+//!		grows with sz, the constant-time algorithm of Perreault and
+//!		Hebert, or SIMD sorting networks for sz <= MEDIAN_NETWORK_MAX.
+//!		MEDIAN_AUTO takes the networks up to MEDIAN_NETWORK_MAX, then
+//!		Huang, and the constant-time algorithm from MEDIAN_CONSTANT_MIN.
+//!		If params.avg_nbrs = k > 0, the output is the rounded average
+//!		of the median and the k window pixels on either side of it in
+//!		rank order; the sorting networks yield the median
+//!		only, so Huang's algorithm takes their kernel sizes then.
+//!		params.border picks the pixels past the edges.
+//!		Each channel is split into params.bands bands of rows. A band
+//!		reads the sz/2 rows above and below it as a halo and keeps its
+//!		own histograms, so bands are filtered independently.
+//!		Return 1 for success, 0 for failure.
+//! \param[in]	I1     - Input image.
+//! \param[in]	params - kernel size, average neighbors to blur with, method,
+//!			 border mode, band count.
+//! \param[out]	I2     - Output image.
+//
+bool
+median(ImagePtr I1, const MedianParams &params, ImagePtr I2) {
+	// error checking
+	if(I1.isNull() || params.sz < 1 || params.avg_nbrs < 0) return 0;
+
+	int sz = params.sz;
+	int w = I1->width();
+	int h = I1->height();
+
+	// at most all the window pixels are averaged
+	int k = MIN(params.avg_nbrs, (sz*sz - 1) / 2);
+
+	// pick algorithm
+	int method = params.method;
+	if (method == MEDIAN_NETWORK && k > 0) method = MEDIAN_HUANG;
+	if (method == MEDIAN_AUTO) {
+		if (sz <= MEDIAN_NETWORK_MAX && !k) method = MEDIAN_NETWORK;
+		else if (sz < MEDIAN_CONSTANT_MIN) method = MEDIAN_HUANG;
+		else				method = MEDIAN_CONSTANT;
+	}
+
+	// networks exist for small kernels only; the uint16_t bins limit
+	// the constant-time kernel size
+	if (method == MEDIAN_NETWORK  && sz > MEDIAN_NETWORK_MAX)  method = MEDIAN_CONSTANT;
+	if (method == MEDIAN_CONSTANT && sz > MEDIAN_CONSTANT_MAX) method = MEDIAN_HUANG;
+
+	// bands read the rows around them, so filtering in place reads a copy
+	int nbands = params.bands > 0 ? params.bands : ThreadPool::global().size();
+	const Border &border = params.border;
+	if (I1 == I2) {
+		ImagePtr I;
+		IP_copyImage(I1, I);
+		I1 = I;
+	}
+
+	IP_copyImageHeader(I1, I2);
+
+	int t;
+	ChannelPtr<uchar> p1, p2;
+	for(int ch = 0; IP_getChannel(I1, ch, p1, t); ch++) {
+		IP_getChannel(I2, ch, p2, t);
+		const uchar *src = &*p1;
+		uchar	    *dst = &*p2;
+
+		int n = MIN(nbands, h);
+		ThreadPool::global().parallelFor(n, [&](int b) {
+			int y0 = (long long) h *  b    / n;
+			int y1 = (long long) h * (b+1) / n;
+			switch (method) {
+			case MEDIAN_NETWORK:  medianNetwork (src, dst, w, h, sz,    border, y0, y1); break;
+			case MEDIAN_CONSTANT: medianConstant(src, dst, w, h, sz, k, border, y0, y1); break;
+			default:	      medianHuang   (src, dst, w, h, sz, k, border, y0, y1); break;
+			}
+		});
+	}
+
+	return 1;
+}
+
+
+
+// ----------------------------------------------------------------------
+// running tracker of the pixel of rank r in a sliding 256-bin histogram
+//
+struct RankTracker {
+	int		r;	// rank tracked, from 0
+	int		v;	// gray level holding rank r
+	int		lt;	// no. of window pixels below v
+	long long	sum;	// sum of those pixels
+
+	// pixel p leaves or enters the window
+	void	remove	(int p) { int b = p < v; lt -= b; sum -= b*p; }
+	void	add	(int p) { int b = p < v; lt += b; sum += b*p; }
+
+	// step v up or down to the bin holding rank r after the updates
+	void	step	(const int *hist) {
+		while (lt > r)		   { v--; lt -= hist[v]; sum -= (long long) v * hist[v]; }
+		while (lt + hist[v] <= r) { lt += hist[v]; sum += (long long) v * hist[v]; v++; }
+	}
+
+	// sum of the pixels of ranks 0 .. r
+	long long prefix() const { return sum + (long long) (r - lt + 1) * v; }
+};
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// medianHuangRanks:
+//
+//! \brief	Median of one channel with a sliding 256-bin histogram.
+//! \details	Algorithm of T. Huang, G. Yang and G. Tang, "A fast
+//!		two-dimensional median filtering algorithm", IEEE TASSP 1979.
+//!		The kernel histogram moves right along each row by removing
+//!		the column leaving the window and adding the column entering
+//!		it. Rather than scanning the histogram from 0 for every pixel,
+//!		the median of the previous pixel is kept together with the
+//!		no. of window pixels below it; each update adjusts that count,
+//!		and the median then steps up or down from where it was, which
+//!		is only a few bins on natural images. Columns are updated
+//!		without border lookups except near the left and right edges.
+//!		Averaging k neighbors on either side of the median tracks the
+//!		ranks r-k and r+k the same way, along with the sums of the
+//!		pixels below them, and takes the difference of those sums.
+//! \param[in]	src    - input channel.
+//! \param[out]	dst    - output channel.
+//! \param[in]	w, h   - channel width and height.
+//! \param[in]	sz     - kernel size.
+//! \param[in]	k      - no. of neighbors in rank order to average on
+//!			 either side of the median.
+//! \param[in]	b      - border mode.
+//! \param[in]	y0, y1 - band of output rows [y0,y1).
+//
+template <int NT>
+static void
+medianHuangRanks(const uchar *src, uchar *dst, int w, int h, int sz, int k, const Border &b, int y0, int y1)
+{
+	// the window of (x,y) spans x-up .. x+dn and y-up .. y+dn;
+	// the median is the pixel of rank r (from 0) in the window
+	int up = (sz-1) / 2;
+	int dn = sz / 2;
+	int r  = (sz*sz) / 2;
+
+	Scratch scratch;
+	const uchar **rows = scratch.alloc<const uchar *>(sz);
+	uchar	     *crow = scratch.alloc<uchar>(w);
+	memset(crow, b.value, w);
+
+	// the median alone (NT = 1), or the ends of the ranks to average (NT = 2)
+	RankTracker t[2];
+	const int nt = NT;
+	t[0].r = r - k;
+	t[1].r = r + k;
+
+	int hist[MXGRAY];
+	for (int y = y0; y<y1; y++) {
+		// window rows
+		for (int j = 0; j<sz; j++)
+			rows[j] = b.row(src, w, h, y-up+j, crow);
+
+		// histogram of the window of pixel 0
+		memset(hist, 0, sizeof(hist));
+		for (int i = -up; i<=dn; i++)
+			for (int j = 0; j<sz; j++)
+				hist[b.pixel(rows[j], i, w)]++;
+
+		for (int i = 0; i<nt; i++) {
+			t[i].v = t[i].lt = 0;
+			t[i].sum = 0;
+			t[i].step(hist);
+		}
+
+		uchar *d = dst + (size_t) y * w;
+		for (int x = 0; x<w; x++) {
+			if (x > 0) {
+				// column x-1-up leaves the window, column x+dn enters;
+				// past the edges they may be the same or the constant
+				int xout = b.index(x-1-up, w);
+				int xin  = b.index(x+dn,   w);
+				if (xout != xin) {
+					for (int j = 0; j<sz; j++) {
+						int vout = xout < 0 ? b.value : rows[j][xout];
+						int vin  = xin  < 0 ? b.value : rows[j][xin];
+						hist[vout]--;
+						hist[vin ]++;
+						for (int i = 0; i<nt; i++) {
+							t[i].remove(vout);
+							t[i].add(vin);
+						}
+					}
+				}
+				for (int i = 0; i<nt; i++)
+					t[i].step(hist);
+			}
+
+			// sum of ranks r-k .. r+k is the difference of the prefix sums
+			if (k)
+				d[x] = (t[1].prefix() - t[0].prefix() + t[0].v + k) / (2*k+1);
+			else	d[x] = t[0].v;
+		}
+	}
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// medianHuang:
+//
+// Huang's median, tracking one rank for the plain median
+// or two for the average of the ranks around it.
+//
+static void
+medianHuang(const uchar *src, uchar *dst, int w, int h, int sz, int k, const Border &b, int y0, int y1)
+{
+	if (k)	medianHuangRanks<2>(src, dst, w, h, sz, k, b, y0, y1);
+	else	medianHuangRanks<1>(src, dst, w, h, sz, 0, b, y0, y1);
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// 16-bin histogram segment arithmetic of the constant-time median
+//
+static inline void
+histAdd(uint16_t *h, const uint16_t *a)
+{
+	for (int i = 0; i<MEDIAN_FINE; i++) h[i] += a[i];
+}
+
+static inline void
+histSlide(uint16_t *h, const uint16_t *in, const uint16_t *out)
+{
+	for (int i = 0; i<MEDIAN_FINE; i++) h[i] += in[i] - out[i];
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// medianConstant:
+//
+//! \brief	Constant-time median of one channel.
+//! \details	Algorithm of S. Perreault and P. Hebert, "Median filtering in
+//!		constant time", IEEE TIP 2007. Every column keeps a histogram of
+//!		its sz pixels in the current window rows, which moves down one
+//!		row per output row at the cost of one removal and one addition.
+//!		The kernel histogram moves right by adding the column histogram
+//!		entering the window and subtracting the one leaving it.
+//!		Histograms have two levels: 16 coarse bins, each the total of
+//!		16 fine bins. Only the coarse bins are moved at every pixel; the
+//!		median is found among them first and then among the 16 fine
+//!		bins of its coarse bin, which are brought up to date only then
+//!		(from the columns passed since they were last used, or rebuilt
+//!		if more than sz columns ago). Cost per pixel does not depend on
+//!		sz. Columns past the left and right edges are the column
+//!		histograms they map to, or an extra one holding sz pixels of
+//!		the constant. Averaging k neighbors on either side
+//!		of the median also slides the sums of the pixels in each coarse
+//!		bin; the sum of the n smallest pixels then takes whole coarse
+//!		bins up to the one holding rank n and the fine bins of that one,
+//!		and the ranks to average are the difference of two such sums.
+//! \param[in]	src    - input channel.
+//! \param[out]	dst    - output channel.
+//! \param[in]	w, h   - channel width and height.
+//! \param[in]	sz     - kernel size; sz <= MEDIAN_CONSTANT_MAX.
+//! \param[in]	k      - no. of neighbors in rank order to average on
+//!			 either side of the median.
+//! \param[in]	b      - border mode.
+//! \param[in]	y0, y1 - band of output rows [y0,y1).
+//
+static void
+medianConstant(const uchar *src, uchar *dst, int w, int h, int sz, int k, const Border &b, int y0, int y1)
+{
+	// the window of (x,y) spans x-up .. x+dn and y-up .. y+dn
+	int up  = (sz-1) / 2;
+	int dn  = sz / 2;
+	int mid = ((sz*sz) / 2) + 1;
+
+	// fine and coarse column histograms in this thread's scratch arena;
+	// column w is the constant column of BORDER_CONSTANT
+	Scratch scratch;
+	uint16_t *colF = scratch.alloc<uint16_t>((size_t) (w+1) * MXGRAY);
+	uint16_t *colC = scratch.alloc<uint16_t>((size_t) (w+1) * MEDIAN_COARSE);
+	memset(colF, 0, (size_t) (w+1) * MXGRAY * sizeof(uint16_t));
+	memset(colC, 0, (size_t) (w+1) * MEDIAN_COARSE * sizeof(uint16_t));
+	colF[w*MXGRAY + b.value] = sz;
+	colC[w*MEDIAN_COARSE + b.value/MEDIAN_FINE] = sz;
+
+	// sums of the column pixels in each coarse bin, when averaging;
+	// sz pixels of at most 255 fit in uint16_t
+	uint16_t *colS = 0;
+	if (k) {
+		colS = scratch.alloc<uint16_t>((size_t) (w+1) * MEDIAN_COARSE);
+		memset(colS, 0, (size_t) (w+1) * MEDIAN_COARSE * sizeof(uint16_t));
+		colS[w*MEDIAN_COARSE + b.value/MEDIAN_FINE] = sz * b.value;
+	}
+
+	// column histogram of column j; past the edges, the one standing in for
+	// it from edge[], which covers j = -up-1 .. -1 and w .. w-1+dn
+	int *edge = scratch.alloc<int>(sz);
+	for (int i = 0; i<sz; i++) {
+		int j = b.index(i<=up ? i-up-1 : w+i-up-1, w);
+		edge[i] = j < 0 ? w : j;
+	}
+	auto col = [&](int j) {
+		return (unsigned) j < (unsigned) w ? j : edge[j < 0 ? j+up+1 : j-w+up+1];
+	};
+
+	// rows past the top and bottom edges in constant mode
+	uchar *crow = scratch.alloc<uchar>(w);
+	for (int x = 0; x<w; x++)
+		crow[x] = b.value;
+
+	// kernel histograms; luc[c] is the column at which fine segment c was last updated
+	uint16_t kerF[MXGRAY], kerC[MEDIAN_COARSE];
+	int	 kerS[MEDIAN_COARSE];
+	int	 luc[MEDIAN_COARSE];
+
+	// column histograms of the window rows of row y0
+	for (int j = y0-up; j<=y0+dn; j++) {
+		const uchar *s = b.row(src, w, h, j, crow);
+		for (int x = 0; x<w; x++) {
+			colF[x*MXGRAY + s[x]]++;
+			colC[x*MEDIAN_COARSE + s[x]/MEDIAN_FINE]++;
+		}
+		if (k)
+			for (int x = 0; x<w; x++)
+				colS[x*MEDIAN_COARSE + s[x]/MEDIAN_FINE] += s[x];
+	}
+
+	for (int y = y0; y<y1; y++) {
+		// move the column histograms down: row y-1-up leaves, row y+dn enters
+		const uchar *out = b.row(src, w, h, y-1-up, crow);
+		const uchar *in  = b.row(src, w, h, y+dn,   crow);
+		if (y > y0 && in != out) {
+			for (int x = 0; x<w; x++) {
+				colF[x*MXGRAY + out[x]]--;
+				colC[x*MEDIAN_COARSE + out[x]/MEDIAN_FINE]--;
+				colF[x*MXGRAY + in[x]]++;
+				colC[x*MEDIAN_COARSE + in[x]/MEDIAN_FINE]++;
+			}
+			if (k)
+				for (int x = 0; x<w; x++) {
+					colS[x*MEDIAN_COARSE + out[x]/MEDIAN_FINE] -= out[x];
+					colS[x*MEDIAN_COARSE + in[x] /MEDIAN_FINE] += in[x];
+				}
+		}
+
+		// coarse kernel histogram of pixel 0; all fine segments are stale
+		memset(kerC, 0, sizeof(kerC));
+		memset(kerS, 0, sizeof(kerS));
+		for (int j = -up; j<=dn; j++) {
+			histAdd(kerC, colC + col(j) * MEDIAN_COARSE);
+			if (k)
+				for (int c = 0; c<MEDIAN_COARSE; c++)
+					kerS[c] += colS[col(j) * MEDIAN_COARSE + c];
+		}
+		for (int c = 0; c<MEDIAN_COARSE; c++)
+			luc[c] = -sz-1;
+
+		// fine segment c brought up to date at column x
+		int x;
+		auto segment = [&](int c) {
+			uint16_t *f = kerF + c*MEDIAN_FINE;
+			int off = c*MEDIAN_FINE;
+			if (x - luc[c] > sz) {
+				memset(f, 0, MEDIAN_FINE * sizeof(uint16_t));
+				for (int j = x-up; j<=x+dn; j++)
+					histAdd(f, colF + col(j) * MXGRAY + off);
+			} else {
+				for (int j = luc[c]+1; j<=x; j++)
+					histSlide(f, colF + col(j+dn)   * MXGRAY + off,
+						     colF + col(j-1-up) * MXGRAY + off);
+			}
+			luc[c] = x;
+			return f;
+		};
+
+		// sum of the n smallest pixels of the window of column x
+		auto prefix = [&](int n) {
+			int c, cnt = 0, sum = 0;
+			for (c = 0; c<MEDIAN_COARSE-1 && cnt + kerC[c] < n; c++) {
+				cnt += kerC[c];
+				sum += kerS[c];
+			}
+			const uint16_t *f = segment(c);
+			for (int i = 0; cnt < n; i++) {
+				int m = MIN(f[i], n - cnt);
+				cnt += m;
+				sum += m * (c*MEDIAN_FINE + i);
+			}
+			return sum;
+		};
+
+		uchar *d = dst + (size_t) y * w;
+		for (x = 0; x<w; x++) {
+			// move the coarse kernel histogram right
+			if (x > 0) {
+				int xin  = col(x+dn)   * MEDIAN_COARSE;
+				int xout = col(x-1-up) * MEDIAN_COARSE;
+				histSlide(kerC, colC + xin, colC + xout);
+				if (k)
+					for (int c = 0; c<MEDIAN_COARSE; c++)
+						kerS[c] += colS[xin + c] - colS[xout + c];
+			}
+
+			// ranks mid-1-k .. mid-1+k (from 0)
+			if (k) {
+				d[x] = (prefix(mid+k) - prefix(mid-1-k) + k) / (2*k+1);
+				continue;
+			}
+
+			// coarse bin c holding the median; sum counts the pixels below it
+			int c, sum = 0;
+			for (c = 0; c<MEDIAN_COARSE-1 && sum + kerC[c] < mid; c++)
+				sum += kerC[c];
+
+			// fine bin i holding the median
+			const uint16_t *f = segment(c);
+			int i;
+			for (i = 0; i<MEDIAN_FINE-1 && sum + f[i] < mid; i++)
+				sum += f[i];
+			d[x] = c*MEDIAN_FINE + i;
+		}
+	}
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// MedianVec: MEDIAN_LANES pixels in one register, and the min/max used
+// by the sorting networks; SSE2 where available, scalar arrays elsewhere.
+//
+#define MEDIAN_LANES	16
+
+#ifdef MEDIAN_SSE2
+typedef __m128i MedianVec;
+static inline MedianVec medLoad (const uchar *p)	    { return _mm_loadu_si128((const __m128i *) p); }
+static inline void	medStore(uchar *p, MedianVec v)	    { _mm_storeu_si128((__m128i *) p, v); }
+static inline MedianVec medMin	(MedianVec a, MedianVec b) { return _mm_min_epu8(a, b); }
+static inline MedianVec medMax	(MedianVec a, MedianVec b) { return _mm_max_epu8(a, b); }
+#else
+struct MedianVec { uchar v[MEDIAN_LANES]; };
+static inline MedianVec medLoad (const uchar *p)	    { MedianVec r; memcpy(r.v, p, MEDIAN_LANES); return r; }
+static inline void	medStore(uchar *p, MedianVec v)	    { memcpy(p, v.v, MEDIAN_LANES); }
+static inline MedianVec medMin	(MedianVec a, MedianVec b)
+	{ for(int i = 0; i < MEDIAN_LANES; ++i) a.v[i] = MIN(a.v[i], b.v[i]); return a; }
+static inline MedianVec medMax	(MedianVec a, MedianVec b)
+	{ for(int i = 0; i < MEDIAN_LANES; ++i) a.v[i] = MAX(a.v[i], b.v[i]); return a; }
+#endif
+
+
+
+//////////////////////////////////////////////////////////////////////////
+///
+/// \class MedianNetwork
+/// \brief Comparators that move the median of n values to wire n/2.
+///
+/// Built from Batcher's odd-even merge sort on the next power of two
+/// >= n. Comparators touching the wires past n are dropped (as if those
+/// held +infinity), and so is every comparator that cannot affect wire
+/// n/2; a comparator of which only one output is used later keeps just
+/// its min or max. For n = 9, 25, 49 this leaves 24, 113 and 319
+/// comparators instead of 28, 140 and 394.
+///
+//////////////////////////////////////////////////////////////////////////
+
+class MedianNetwork {
+public:
+	enum { BOTH, MINONLY, MAXONLY };
+	struct Comparator {
+		int a, b;	// wires; a receives the min, b the max
+		int op;		// BOTH, MINONLY or MAXONLY
+	};
+
+	MedianNetwork(int n);
+	std::vector<Comparator> comparators;
+};
+
+MedianNetwork::MedianNetwork(int n)
+{
+	int P = 1;
+	while (P < n) P <<= 1;
+
+	// Batcher's odd-even merge sort of P wires
+	std::vector<Comparator> sort;
+	for (int p = 1; p<P; p <<= 1)
+	for (int k = p; k>=1; k >>= 1)
+	for (int j = k % p; j+k<P; j += 2*k)
+	for (int i = 0; i<k; i++) {
+		Comparator c = { i+j, i+j+k, BOTH };
+		if ((c.a / (2*p)) == (c.b / (2*p)) && c.b < n)
+			sort.push_back(c);
+	}
+
+	// walk back from the median wire, keeping what it depends on
+	std::vector<bool> need(n, false);
+	need[n/2] = true;
+	for (int i = (int) sort.size() - 1; i>=0; i--) {
+		Comparator c = sort[i];
+		if (!need[c.a] && !need[c.b]) continue;
+		if (!need[c.b])	c.op = MINONLY;
+		else if (!need[c.a]) c.op = MAXONLY;
+		need[c.a] = need[c.b] = true;
+		comparators.insert(comparators.begin(), c);
+	}
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// medianNetworkSize:
+//
+//! \brief	Sorting network median of one channel for SZ x SZ kernels.
+//! \details	Each output row is computed MEDIAN_LANES pixels at a time:
+//!		the SZ*SZ neighbors of the lanes are loaded as SZ*SZ vectors
+//!		and pushed through the comparators of the median network with
+//!		vector min/max, so there are no branches on pixel values. The
+//!		SZ input rows of the window are kept in a ring, padded with
+//!		the pixels past the edges, so the loads never leave a row.
+//! \param[in]	src    - input channel.
+//! \param[out]	dst    - output channel.
+//! \param[in]	w, h   - channel width and height.
+//! \param[in]	b      - border mode.
+//! \param[in]	y0, y1 - band of output rows [y0,y1).
+//
+template <int SZ>
+static void
+medianNetworkSize(const uchar *src, uchar *dst, int w, int h, const Border &b, int y0, int y1)
+{
+	enum { N = SZ*SZ, UP = (SZ-1)/2, DN = SZ/2 };
+	static const MedianNetwork net(N);
+	const MedianNetwork::Comparator *cmp = &net.comparators[0];
+	int ncmp = (int) net.comparators.size();
+
+	// rows are padded to a whole no. of vectors plus the kernel overhang
+	int wv = (w + MEDIAN_LANES-1) / MEDIAN_LANES * MEDIAN_LANES;
+	int pw = wv + SZ - 1;
+
+	Scratch scratch;
+	uchar *ring = scratch.alloc<uchar>((size_t) SZ * pw);
+	uchar *out  = scratch.alloc<uchar>(wv);
+	// padded copy of row j in ring slot (j+UP) % SZ; j >= -UP
+	auto fill = [&](int j) {
+		uchar *r = ring + (size_t) ((j + UP) % SZ) * pw;
+		int jj = b.index(j, h);
+		if (jj < 0) {
+			memset(r, b.value, pw);
+			return;
+		}
+		const uchar *s = src + (size_t) jj * w;
+		for (int i = 0; i<UP; i++)
+			r[i] = b.pixel(s, i-UP, w);
+		memcpy(r + UP, s, w);
+		for (int i = UP+w; i<pw; i++)
+			r[i] = b.pixel(s, i-UP, w);
+	};
+	for (int j = y0-UP; j<y0+DN; j++)
+		fill(j);
+
+	MedianVec v[N];
+	for (int y = y0; y<y1; y++) {
+		// row y+DN enters the window
+		fill(y + DN);
+		const uchar *rows[SZ];
+		for (int k = 0; k<SZ; k++)
+			rows[k] = ring + (size_t) ((y + k) % SZ) * pw;
+
+		for (int x = 0; x<wv; x += MEDIAN_LANES) {
+			for (int k = 0; k<SZ; k++)
+				for (int i = 0; i<SZ; i++)
+					v[k*SZ + i] = medLoad(rows[k] + x + i);
+
+			for (int c = 0; c<ncmp; c++) {
+				MedianVec a = v[cmp[c].a];
+				MedianVec b = v[cmp[c].b];
+				if (cmp[c].op != MedianNetwork::MAXONLY) v[cmp[c].a] = medMin(a, b);
+				if (cmp[c].op != MedianNetwork::MINONLY) v[cmp[c].b] = medMax(a, b);
+			}
+			medStore(out + x, v[N/2]);
+		}
+		memcpy(dst + (size_t) y * w, out, w);
+	}
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// medianNetwork:
+//
+// Dispatch rows [y0,y1) to the sorting network median for kernel size sz.
+// Return 0 if there is none for sz (> MEDIAN_NETWORK_MAX).
+//
+static bool
+medianNetwork(const uchar *src, uchar *dst, int w, int h, int sz, const Border &b, int y0, int y1)
+{
+	switch (sz) {
+	case 1: memcpy(dst + (size_t) y0*w, src + (size_t) y0*w, (size_t) (y1-y0) * w); return 1;
+	case 2: medianNetworkSize<2>(src, dst, w, h, b, y0, y1); return 1;
+	case 3: medianNetworkSize<3>(src, dst, w, h, b, y0, y1); return 1;
+	case 4: medianNetworkSize<4>(src, dst, w, h, b, y0, y1); return 1;
+	case 5: medianNetworkSize<5>(src, dst, w, h, b, y0, y1); return 1;
+	case 6: medianNetworkSize<6>(src, dst, w, h, b, y0, y1); return 1;
+	case 7: medianNetworkSize<7>(src, dst, w, h, b, y0, y1); return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,37 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// MedianKernel.h - Headless median filter kernel
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#ifndef MEDIANKERNEL_H
+#define MEDIANKERNEL_H
+
+#include "IP.h"
+#include "Border.h"
+using namespace IP;
+
+// median algorithms; MEDIAN_AUTO picks the fastest one for the kernel size
+enum { MEDIAN_AUTO, MEDIAN_HUANG, MEDIAN_CONSTANT, MEDIAN_NETWORK };
+
+// ----------------------------------------------------------------------
+// median parameters; filled in by the Median widget or by a batch job
+//
+struct MedianParams {
+	int	sz;		// kernel size
+	int	avg_nbrs;	// no. of neighbors to average with the median
+	int	method;		// MEDIAN_AUTO, MEDIAN_HUANG, MEDIAN_CONSTANT or MEDIAN_NETWORK
+	Border	border;		// pixels past the edges
+	int	bands;		// no. of bands of rows, run on the global thread pool;
+				// 0: one per pool thread, 1: serial
+
+	MedianParams(int s = 1, int a = 0, int m = MEDIAN_AUTO, int b = 0)
+		: sz(s), avg_nbrs(a), method(m), bands(b) {}
+};
+
+bool	median(ImagePtr I1, const MedianParams &params, ImagePtr I2);
+
+#endif	// MEDIANKERNEL_H
@@ -0,0 +1,154 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// PointLut.cpp - Point operation lookup tables composed into one pass
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#include "PointLut.h"
+#include "ThreadPool.h"
+#include <vector>
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// PointLut::PointLut:
+//
+// Constructor. Identity table.
+//
+PointLut::PointLut()
+{
+	for(int i = 0; i < MXGRAY; ++i) map[i] = i;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// PointLut::then:
+//
+// Compose next after this table: level i now maps to next.map[map[i]].
+//
+void
+PointLut::then(const PointLut &next)
+{
+	for(int i = 0; i < MXGRAY; ++i) map[i] = next.map[map[i]];
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// PointLut::mapHistogram:
+//
+//! \brief	Histogram of an image after mapping it by this table.
+//! \details	Level i moves its count to map[i], so a point operation later
+//!		in a fused run sees the same histogram it would have
+//!		computed from the intermediate image.
+//! \param[in]	hist - histogram of the input, MXGRAY entries.
+//! \param[out]	out  - histogram of the output, MXGRAY entries.
+//
+void
+PointLut::mapHistogram(const int *hist, int *out) const
+{
+	int i;
+	for(i = 0; i < MXGRAY; ++i) out[i] = 0;
+	for(i = 0; i < MXGRAY; ++i) out[map[i]] += hist[i];
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// pointLut:
+//
+//! \brief	Map every pixel of I1 through lut. Output is in I2.
+//! \details	I1 and I2 may be the same image.
+//!		Return 1 for success, 0 for failure.
+//! \param[in]	I1  - Input image.
+//! \param[in]	lut - Table of the point operation.
+//! \param[out]	I2  - Output image.
+//
+bool
+pointLut(ImagePtr I1, const PointLut &lut, ImagePtr I2)
+{
+	// error checking
+	if(I1.isNull()) return 0;
+
+	std::vector<PointLut> luts(I1->maxChannel(), lut);
+	return pointLut(I1, &luts[0], I2);
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// pointLut:
+//
+//! \brief	Map channel ch of I1 through luts[ch]. Output is in I2.
+//! \details	All channels are mapped in one sweep of POINT_BLOCK pixel
+//!		blocks, so each block of every channel is read and written
+//!		while the others are still in cache, and the blocks run in
+//!		parallel. I1 and I2 may be the same image.
+//!		Return 1 for success, 0 for failure.
+//! \param[in]	I1   - Input image.
+//! \param[in]	luts - One table per channel of I1.
+//! \param[out]	I2   - Output image.
+//
+bool
+pointLut(ImagePtr I1, const PointLut *luts, ImagePtr I2)
+{
+	// error checking
+	if(I1.isNull()) return 0;
+
+	IP_copyImageHeader(I1, I2);
+	int w = I1->width();
+	int h = I1->height();
+	int total = w * h;
+
+	// channel planes of the input and output
+	int type;
+	ChannelPtr<uchar> p1, p2;
+	std::vector<const uchar*> src;
+	std::vector<uchar*>	  dst;
+	for(int ch = 0; IP_getChannel(I1, ch, p1, type); ch++) {
+		IP_getChannel(I2, ch, p2, type);
+		src.push_back(&*p1);
+		dst.push_back(&*p2);
+	}
+	int nch = (int) src.size();
+
+	int nblocks = (total + POINT_BLOCK-1) / POINT_BLOCK;
+	ThreadPool::global().parallelFor(nblocks, [&](int b) {
+		int x = b * POINT_BLOCK;
+		int n = MIN(POINT_BLOCK, total - x);
+		for(int ch = 0; ch < nch; ch++)
+			pointLutRow(src[ch] + x, luts[ch], dst[ch] + x, n);
+	});
+
+	return 1;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// pointLutRow:
+//
+//! \brief	Map n pixels through lut: dst[x] = lut.map[src[x]].
+//! \details	Four pixels are looked up per iteration, which lets their
+//!		loads overlap. src and dst may be the same.
+//! \param[in]	src - input pixels.
+//! \param[in]	lut - table of the point operation.
+//! \param[out]	dst - output pixels.
+//! \param[in]	n   - no. of pixels.
+//
+void
+pointLutRow(const uchar *src, const PointLut &lut, uchar *dst, int n)
+{
+	const uchar *map = lut.map;
+	int x = 0;
+	for(; x + 4 <= n; x += 4) {
+		uchar a = map[src[x]],   b = map[src[x+1]];
+		uchar c = map[src[x+2]], d = map[src[x+3]];
+		dst[x] = a; dst[x+1] = b; dst[x+2] = c; dst[x+3] = d;
+	}
+	for(; x < n; ++x) dst[x] = map[src[x]];
+}
@@ -0,0 +1,49 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// PointLut.h - Point operation lookup tables composed into one pass
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#ifndef POINTLUT_H
+#define POINTLUT_H
+
+#include "IP.h"
+using namespace IP;
+
+//////////////////////////////////////////////////////////////////////////
+///
+/// \class PointLut
+/// \brief Output gray level for each input gray level of a point operation.
+///
+/// Threshold, contrast, quantization and histogram stretching each fill
+/// one. A run of them collapses into a single table with then(), which
+/// costs 256 lookups instead of a pass over the image, and the image is
+/// then mapped once by pointLut(). Rows are mapped by pointLutRow().
+///
+/// pointLut() sweeps the image once, a block of pixels at a time, mapping
+/// that block in every channel before moving on; each channel may have
+/// its own table. Blocks are spread over the global thread pool.
+///
+//////////////////////////////////////////////////////////////////////////
+
+class PointLut {
+public:
+	PointLut	();				// identity
+
+	void	then	(const PointLut &next);		// map by this table, then by next
+	void	mapHistogram(const int *hist, int *out) const;	// histogram of the mapped image
+
+	uchar	map[MXGRAY];	// output level of each input level
+};
+
+// pixels per channel in one block of the pointLut() sweep
+#define POINT_BLOCK	(16*1024)
+
+bool	pointLut	(ImagePtr I1, const PointLut &lut,  ImagePtr I2);
+bool	pointLut	(ImagePtr I1, const PointLut *luts, ImagePtr I2);
+void	pointLutRow	(const uchar *src, const PointLut &lut, uchar *dst, int n);
+
+#endif	// POINTLUT_H
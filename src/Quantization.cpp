@@ -46,9 +46,7 @@ Quantization::applyFilter(ImagePtr I1, ImagePtr I2)
 	if(quan < 0 || quan> MXGRAY) return 0;
 
 	// apply filter
-	quantization(I1, quan, dither, I2);
-
-	return 1;
+	return quantization(I1, QuantizationParams(quan, dither), I2);
 }
 
 
@@ -135,102 +133,6 @@ Quantization::changeQuan(int quan)
 
 
 
-// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-// Quantization::quantization:
-//
-//Quantization I1 using the 2-level mapping shown below.  Output is in I2.
-//! \brief	To quantize we add or subtract a bias value from each pixel
-//! \details	Add dither to pixel values if dither = 1 else quantize without dither
-//! \param[in]	I1  - Input image.
-//! \param[in]	quan - Quantization.
-//! \param[in]	dither - dither.
-//! \param[out]	I2  - Output image.
-//
-void
-Quantization::quantization(ImagePtr I1, int quan, int dither, ImagePtr I2) {
-	IP_copyImageHeader(I1, I2);
-	int w = I1->width();
-	int h = I1->height();
-	int total = w * h;
-
-	// variable for quantization levels
-	int levels = quan;
-
-	// scale is the value to add or subtract from each pixel
-  int scale = (MXGRAY + 1) / levels;
-
-	// bias brings the scale down by a factor of 2
-	// will add bias to each point
-	double bias = scale/2.0;
-
-	// compute lut[]
-	int i, lut[MXGRAY];
-  for(i=0;  i<=MXGRAY; ++i)
-			lut[i] = scale * (int) (i/scale) + bias;
-
-	int pixel = 0;
-	// int noise is the dither noise to add to each pixel
-	// int sign is sign of dither noise. It tells if to add or subtract noise
-	// on odd row always add negative noise, on even row always add positive noise
-	int noise, sign;
-
-  int type;
-	ChannelPtr<uchar> p1, p2, endd;
-
-	// check if dither checkbox is checked or not
-	// if not checked copy values from lut to I2
-  if (!dither) {
-		for(int ch = 0; IP_getChannel(I1, ch, p1, type); ch++) {
-			IP_getChannel(I2, ch, p2, type);
-			for(endd = p1 + total; p1<endd;) *p2++ = lut[*p1++];
-		}
-	}
-
-	// else if dither is checked, apply dither to each pixel value
-  else {
-		for(int ch = 0; IP_getChannel(I1, ch, p1, type); ch++) {
-			IP_getChannel(I2, ch, p2, type);
-			for (int y=0; y<h; y++)
-			{
-				 // if row is odd, intiialize sign to 1
-				 if (y % 2)
-				 	sign = 1;
-
-				 // else if row is even, intiialize sign to -1
-				 else
-				 	sign = -1;
-
-				 for (int x=0; x<w; x++)
-						{
-							// 2^5 = 32767  // gives a number b/w 0-1
-							noise = ((rand()&0x7fff) / 32767.) * bias;
-
-							// alternating the noise addition or subtraction
-							switch(sign)
-							{
-								// on odd row adding negative value
-								case 1:
-								 				// adding noise to pixel
-												pixel = *p1++ + noise;
-												sign = -1;
-												break;
-								// on even row adding positive value
-								case -1:
-								 				// subtracting noise form pixel
-												pixel = *p1++ - noise;
-												sign = 1;
-												break;
-							}
-
-							// purpose of clipping is to make sure output pixel value does not goes off range
-							// clipping the pixel value after applying the dither and before copying to output image
-							*p2++ = lut[ CLIP(pixel, 0, MaxGray)];
-							}
-						}
-					}
-				}
-}
-
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // Quantization::reset:
 //
@@ -11,6 +11,7 @@
 #define QUANTIZATION_H
 
 #include "ImageFilter.h"
+#include "QuantizationKernel.h"
 
 
 class Quantization : public ImageFilter {
@@ -22,9 +23,6 @@ public:
 	bool		applyFilter(ImagePtr, ImagePtr);// apply filter to input to init output
 	void		reset		();		// reset parameters
 
-protected:
-	void quantization(ImagePtr I1, int quan, int dither, ImagePtr I2);
-
 protected slots:
 	void changeQuan(int);
 
@@ -0,0 +1,133 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// QuantizationKernel.cpp - Headless quantization kernel
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#include "QuantizationKernel.h"
+#include <cstdlib>
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// quantization:
+//
+//Quantization I1 using the 2-level mapping shown below.  Output is in I2.
+//! \brief	To quantize we add or subtract a bias value from each pixel
+//! \details	Add dither to pixel values if dither = 1 else quantize without dither
+//!		Return 1 for success, 0 for failure.
+//! \param[in]	I1     - Input image.
+//! \param[in]	params - Quantization levels and dither flag.
+//! \param[out]	I2     - Output image.
+//
+bool
+quantization(ImagePtr I1, const QuantizationParams &params, ImagePtr I2) {
+	// error checking
+	if(I1.isNull()) return 0;
+
+	int dither = params.dither;
+
+	// compute lut[]
+	PointLut lut;
+	if(!quantizationLut(params, lut)) return 0;
+
+	// check if dither checkbox is checked or not
+	// if not checked copy values from lut to I2
+	if (!dither) return pointLut(I1, lut, I2);
+
+	IP_copyImageHeader(I1, I2);
+	int w = I1->width();
+	int h = I1->height();
+
+	// bias brings the scale down by a factor of 2
+	// noise is at most bias
+	int scale = (MXGRAY + 1) / params.levels;
+	double bias = scale/2.0;
+
+	int pixel = 0;
+	// int noise is the dither noise to add to each pixel
+	// int sign is sign of dither noise. It tells if to add or subtract noise
+	// on odd row always add negative noise, on even row always add positive noise
+	int noise, sign;
+
+  int type;
+	ChannelPtr<uchar> p1, p2;
+
+	// dither is checked, apply dither to each pixel value
+	for(int ch = 0; IP_getChannel(I1, ch, p1, type); ch++) {
+		IP_getChannel(I2, ch, p2, type);
+		for (int y=0; y<h; y++)
+		{
+			 // if row is odd, intiialize sign to 1
+			 if (y % 2)
+			 	sign = 1;
+
+			 // else if row is even, intiialize sign to -1
+			 else
+			 	sign = -1;
+
+			 for (int x=0; x<w; x++)
+					{
+						// 2^5 = 32767  // gives a number b/w 0-1
+						noise = ((rand()&0x7fff) / 32767.) * bias;
+
+						// alternating the noise addition or subtraction
+						switch(sign)
+						{
+							// on odd row adding negative value
+							case 1:
+							 				// adding noise to pixel
+											pixel = *p1++ + noise;
+											sign = -1;
+											break;
+							// on even row adding positive value
+							case -1:
+							 				// subtracting noise form pixel
+											pixel = *p1++ - noise;
+											sign = 1;
+											break;
+						}
+
+						// purpose of clipping is to make sure output pixel value does not goes off range
+						// clipping the pixel value after applying the dither and before copying to output image
+						*p2++ = lut.map[ CLIP(pixel, 0, MaxGray)];
+						}
+					}
+				}
+
+	return 1;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// quantizationLut:
+//
+// Fill lut with the quantization mapping without dither, for
+// quantization() or a fused chain. Levels past the last whole step
+// clip to MaxGray. Return 1 for success, 0 for levels out of range.
+//
+bool
+quantizationLut(const QuantizationParams &params, PointLut &lut)
+{
+	if(params.levels < 1 || params.levels > MXGRAY) return 0;
+
+	// variable for quantization levels
+	int levels = params.levels;
+
+	// scale is the value to add or subtract from each pixel
+	int scale = (MXGRAY + 1) / levels;
+
+	// bias brings the scale down by a factor of 2
+	// will add bias to each point
+	double bias = scale/2.0;
+
+	int i;
+	for(i=0; i<MXGRAY; ++i)
+		lut.map[i] = MIN((int) (scale * (i/scale) + bias), MaxGray);
+
+	return 1;
+}
@@ -0,0 +1,30 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// QuantizationKernel.h - Headless quantization kernel
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#ifndef QUANTIZATIONKERNEL_H
+#define QUANTIZATIONKERNEL_H
+
+#include "IP.h"
+#include "PointLut.h"
+using namespace IP;
+
+// ----------------------------------------------------------------------
+// quantization parameters; filled in by the Quantization widget or by a batch job
+//
+struct QuantizationParams {
+	int	levels;		// no. of quantization levels
+	int	dither;		// add dither noise before quantizing (0 or 1)
+
+	QuantizationParams(int l = 4, int d = 0) : levels(l), dither(d) {}
+};
+
+bool	quantization(ImagePtr I1, const QuantizationParams &params, ImagePtr I2);
+bool	quantizationLut(const QuantizationParams &params, PointLut &lut);
+
+#endif	// QUANTIZATIONKERNEL_H
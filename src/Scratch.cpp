@@ -0,0 +1,194 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// Scratch.cpp - Per-thread scratch memory for kernel line buffers
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#include "Scratch.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <atomic>
+
+#define SCRATCH_ALIGN	32
+
+static std::atomic<long long> s_allocations(0);
+static std::atomic<long long> s_bytes(0);
+
+// ----------------------------------------------------------------------
+// one thread's arena: a single block used as a stack, plus overflow
+// blocks handed out while a frame needed more than the block holds
+//
+struct Scratch::Arena {
+	void			*block;		// heap block holding base
+	char			*base;		// arena, aligned within block
+	size_t			 size;		// size of base
+	size_t			 used;		// bytes in use by open frames
+	int			 depth;		// no. of open frames
+	std::vector<void*>	 overflow;	// blocks allocated past size
+	size_t			 overflowBytes;	// total size of overflow blocks
+
+	Arena() : block(0), base(0), size(0), used(0), depth(0), overflowBytes(0) {}
+	~Arena() {
+		free(block);
+		for(size_t i = 0; i < overflow.size(); ++i) free(overflow[i]);
+	}
+};
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// heapAlloc:
+//
+// Counted malloc; exits if memory runs out, like the kernels always did.
+//
+static void*
+heapAlloc(size_t bytes)
+{
+	void *p = malloc(bytes);
+	if(p == NULL) {
+		fprintf(stderr, "scratch: out of memory (%lu bytes)\n", (unsigned long) bytes);
+		exit(1);
+	}
+	s_allocations++;
+	s_bytes += bytes;
+	return p;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// alignUp:
+//
+// First SCRATCH_ALIGN boundary at or after p.
+//
+static char*
+alignUp(void *p)
+{
+	return (char *) (((size_t) p + SCRATCH_ALIGN - 1) & ~(size_t) (SCRATCH_ALIGN - 1));
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Scratch::threadArena:
+//
+// Arena of the calling thread; created on first use.
+//
+Scratch::Arena*
+Scratch::threadArena()
+{
+	static thread_local Arena arena;
+	return &arena;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Scratch::Scratch:
+//
+// Constructor. Open a frame on this thread's arena.
+//
+Scratch::Scratch()
+	: m_arena(threadArena())
+{
+	m_mark = m_arena->used;
+	m_arena->depth++;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Scratch::~Scratch:
+//
+// Destructor. Release the frame; when the outermost frame closes, fold
+// any overflow blocks into one arena block big enough for all of them.
+//
+Scratch::~Scratch()
+{
+	Arena *a = m_arena;
+	a->used = m_mark;
+	if(--a->depth || a->overflow.empty()) return;
+
+	size_t size = a->size + a->overflowBytes;
+	for(size_t i = 0; i < a->overflow.size(); ++i) free(a->overflow[i]);
+	a->overflow.clear();
+	a->overflowBytes = 0;
+
+	free(a->block);
+	a->block = heapAlloc(size + SCRATCH_ALIGN);
+	a->base	 = alignUp(a->block);
+	a->size	 = size;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Scratch::alloc:
+//
+//! \brief	Return bytes of uninitialized memory valid until the frame closes.
+//! \details	Served from the arena when it fits; otherwise from a new
+//!		block that is merged into the arena later. The memory is
+//!		aligned to SCRATCH_ALIGN bytes: the arena base is aligned
+//!		within its heap block and sizes are rounded up.
+//! \param[in]	bytes - requested size.
+//
+void*
+Scratch::alloc(size_t bytes)
+{
+	Arena *a = m_arena;
+	bytes = (bytes + SCRATCH_ALIGN - 1) & ~(size_t) (SCRATCH_ALIGN - 1);
+
+	if(a->used + bytes <= a->size) {
+		void *p = a->base + a->used;
+		a->used += bytes;
+		return p;
+	}
+
+	// overflow: over-allocate so the block can be aligned
+	char *p = (char *) heapAlloc(bytes + SCRATCH_ALIGN);
+	a->overflow.push_back(p);
+	a->overflowBytes += bytes + SCRATCH_ALIGN;
+	return alignUp(p);
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Scratch::reserve:
+//
+// Grow the calling thread's arena to at least bytes so that the frames
+// of one image are served without further allocation. Ignored while a
+// frame is open on this thread.
+//
+void
+Scratch::reserve(size_t bytes)
+{
+	Arena *a = threadArena();
+	bytes += SCRATCH_ALIGN;
+	if(a->depth || bytes <= a->size) return;
+
+	free(a->block);
+	a->block = heapAlloc(bytes + SCRATCH_ALIGN);
+	a->base	 = alignUp(a->block);
+	a->size	 = bytes;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Scratch::stats:
+//
+// Heap allocations made for scratch memory by all threads so far.
+//
+ScratchStats
+Scratch::stats()
+{
+	ScratchStats st;
+	st.allocations = s_allocations;
+	st.bytes       = s_bytes;
+	return st;
+}
@@ -0,0 +1,60 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// Scratch.h - Per-thread scratch memory for kernel line buffers
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#ifndef SCRATCH_H
+#define SCRATCH_H
+
+#include <cstddef>
+
+// ----------------------------------------------------------------------
+// process-wide counters of the heap traffic caused by scratch memory.
+// Once the arenas have grown to fit an image, both stay flat.
+//
+struct ScratchStats {
+	long long	allocations;	// no. of heap blocks allocated
+	long long	bytes;		// total bytes allocated
+};
+
+//////////////////////////////////////////////////////////////////////////
+///
+/// \class Scratch
+/// \brief Stack-like view of this thread's scratch arena.
+///
+/// A Scratch object opens a frame on the calling thread's arena; memory
+/// from alloc() is valid until the object goes out of scope. Frames nest.
+/// The arena keeps its memory between frames, so line buffers taken in a
+/// hot loop cost a pointer bump instead of a malloc/free pair. If a frame
+/// outgrows the arena, the extra block is merged into the arena when the
+/// outermost frame closes, so the next image needs no new allocation.
+///
+//////////////////////////////////////////////////////////////////////////
+
+class Scratch {
+public:
+	Scratch		();
+	~Scratch	();
+	void*		alloc	(size_t bytes);			// uninitialized, 32-byte aligned
+	template <class T>
+	T*		alloc	(size_t n) { return (T*) alloc(n * sizeof(T)); }
+
+	static void		reserve	(size_t bytes);		// grow this thread's arena
+	static ScratchStats	stats	();			// counters for all threads
+
+private:
+	Scratch		(const Scratch &);			// not copyable
+	void operator=	(const Scratch &);
+
+	struct Arena;
+	static Arena*	threadArena();
+
+	Arena		*m_arena;	// this thread's arena
+	size_t		 m_mark;	// arena offset when the frame opened
+};
+
+#endif	// SCRATCH_H
@@ -11,6 +11,7 @@
 #define SHARPEN_H
 
 #include "ImageFilter.h"
+#include "SharpenKernel.h"
 
 class Sharpen : public ImageFilter {
 	Q_OBJECT
@@ -21,12 +22,6 @@ public:
 	bool		applyFilter(ImagePtr, ImagePtr);    // apply filter to input to init output
 	void		reset		();		                      // reset parameters
 
-protected:
-  void sharpblur(ImagePtr I1, int xsz, int ysz, ImagePtr I2);
-	template <class T>
-	void sharpIP_blur1D (ChannelPtr<T> src, int len, int stride, double ww, ChannelPtr<T> dst);
-	void sharpen(ImagePtr I1, int sz, double fctr, ImagePtr I2);
-
 protected slots:
 	void    changeSize (int);
 	void    changeFactor (int);
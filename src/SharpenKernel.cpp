@@ -0,0 +1,209 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// SharpenKernel.cpp - Headless unsharp mask kernel
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#include "SharpenKernel.h"
+#include "ThreadPool.h"
+#include "BoxFilter.h"
+#include "Scratch.h"
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+
+template <class T, class S, class M>
+static void sharpenChannel(const T *src, T *dst, int w, int h, int sz, M op,
+			   const Border &border, int nbands);
+static void sharpenRow(const uchar *src, const uchar *blur, int w, const uchar *lut, uchar *dst);
+static void sharpenRow(const float *src, const float *blur, int w, double fctr, float *dst);
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// sharpen:
+//
+//! \brief    Sharpen adds the scaled difference between I1 and its box blur to I1.
+//! \details	The blur and the sharpened output are computed in one sweep
+//!		(see sharpenChannel), so no blurred copy of I1 is made.
+//!		Return 1 for success, 0 for failure.
+//! \param[in]	I1     - Input image.
+//! \param[in]	params - filter size, sharpen factor, border mode and band count.
+//! \param[out]	I2     - Output image.
+//
+bool
+sharpen(ImagePtr I1, const SharpenParams &params, ImagePtr I2) {
+	// error checking
+	if(I1.isNull() || params.sz < 1) return 0;
+
+	int sz = params.sz;
+	int w = I1->width();
+	int h = I1->height();
+
+	// trivial case:
+	// a window of one pixel or larger than the image leaves the blur equal
+	// to the input, so the difference is 0 and the image is unchanged
+	if (sz <= 1 || sz > w || sz > h) {
+		if (I1 != I2)
+			IP_copyImage(I1, I2);
+		return 1;
+	}
+
+	// bands read the rows below them, which must not be overwritten yet
+	int nbands = params.bands > 0 ? params.bands : ThreadPool::global().size();
+	if (I1 == I2) nbands = 1;
+
+	// uchar output for each input value s and clipped difference d = s - blur:
+	// lut[s*MXGRAY + d] = CLIP(s + d*fctr, 0, 255)
+	std::vector<uchar> lut(MXGRAY * MXGRAY);
+	for (int i = 0; i<MXGRAY; i++)
+		for (int d = 0; d<MXGRAY; d++)
+			lut[i*MXGRAY + d] = CLIP(i + d * params.fctr, 0, MaxGray);
+
+	IP_copyImageHeader(I1, I2);
+	int type;
+	ChannelPtr<uchar> src, dst;
+	ChannelPtr<float> fdst;
+
+	for(int ch = 0; IP_getChannel(I1, ch, src, type); ch++) {
+		// type is uchar pixel; 16-bit column sums while they cannot overflow
+		if (type == UCHAR_TYPE) {
+			dst = I2[ch];
+			if (sz <= BOX_MAXU16)
+				sharpenChannel<uchar, uint16_t>(&*src, &*dst, w, h, sz, &lut[0], params.border, nbands);
+			else	sharpenChannel<uchar, int>     (&*src, &*dst, w, h, sz, &lut[0], params.border, nbands);
+		}
+
+		// float type from image copying; sharpened in place
+		else {
+			IP_castChannel(I1, ch, I2, ch, FLOAT_TYPE);
+			fdst = I2[ch];
+			sharpenChannel<float, double>(&*fdst, &*fdst, w, h, sz, params.fctr, params.border, 1);
+		}
+	}
+	return 1;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// sharpenChannel:
+//
+//! \brief	Fused box blur and unsharp mask of one channel.
+//! \details	Each band of output rows keeps the horizontally blurred rows
+//!		of its vertical window in a ring, plus one running sum per
+//!		column. Moving down a row blurs only the row entering the
+//!		window, updates the column sums, and writes the output row from
+//!		the input row and the sums, so the working set is sz+3 rows per
+//!		band rather than a blurred copy of the channel. A band starts by
+//!		filling its window from the rows above it. The row blur and the
+//!		column steps are those of the box blur engine (BoxFilter.h), so
+//!		the blur is exactly that of blur() with an sz x sz window.
+//! \param[in]	src    - input channel.
+//! \param[out]	dst    - output channel; may equal src if nbands is 1.
+//! \param[in]	w, h   - channel width and height.
+//! \param[in]	sz     - blur window size; 1 < sz <= w, h.
+//! \param[in]	op     - uchar output table (see sharpen) for uchar,
+//!			 sharpen factor for float; passed to sharpenRow.
+//! \param[in]	border - border mode of the blur.
+//! \param[in]	nbands - no. of bands.
+//
+template <class T, class S, class M>
+static void
+sharpenChannel(const T *src, T *dst, int w, int h, int sz, M op,
+	       const Border &border, int nbands)
+{
+	// the window of row y spans rows y-up .. y+dn
+	int up = (sz-1) / 2;
+	int dn = sz / 2;
+	BoxDivisor dv(sz);
+
+	// ring of sz rows plus a spare, column sums, the blurred row, the
+	// constant border row, dn rows past the bottom and the edge pixels of boxBlurRow
+	size_t scratch = (sz+1) * (w*sizeof(T) + sizeof(T*)) + w * (sizeof(S) + (dn+2)*sizeof(T))
+		       + sz * sizeof(T) + (sz+8) * 32;
+
+	int n = MIN(nbands, h);
+	ThreadPool::global().parallelFor(n, [&](int b) {
+		int y0 = (long long) h *  b    / n;
+		int y1 = (long long) h * (b+1) / n;
+
+		Scratch::reserve(scratch);
+		Scratch mem;
+		T **ring = mem.alloc<T*>(sz+1);
+		S  *sum  = mem.alloc<S>(w);
+		T  *blur = mem.alloc<T>(w);
+		T  *crow = mem.alloc<T>(w);
+		for (int i = 0; i<=sz; i++)
+			ring[i] = mem.alloc<T>(w);
+		std::fill(crow, crow + w, (T) border.value);
+
+		// blurred rows past the bottom edge, for every band whose window
+		// slides past it; made before any output is written: with src
+		// equal to dst they may reflect or wrap onto it
+		T *tail = 0;
+		if (y1-1 + dn >= h) {
+			tail = mem.alloc<T>((size_t) dn * w);
+			for (int i = 0; i<dn; i++)
+				boxBlurRow(border.row(src, w, h, h+i, crow), w, dv, border, tail + (size_t) i*w);
+		}
+
+		// fill the window of row y0; ring[sz] is the spare,
+		// blur[] is still an empty row to add the rows against
+		memset(sum,  0, w * sizeof(S));
+		memset(blur, 0, w * sizeof(T));
+		for (int i = 0; i<sz; i++) {
+			boxBlurRow(border.row(src, w, h, y0 - up + i, crow), w, dv, border, ring[i]);
+			boxAddRow(sum, ring[i], blur, w);
+		}
+
+		// ring[head] holds the oldest row of the window
+		for (int y = y0, head = 0; y<y1; y++) {
+			boxDivideRow(sum, dv, blur, w);
+			sharpenRow(src + (size_t) y*w, blur, w, op, dst + (size_t) y*w);
+
+			if (y+1 == y1) break;
+
+			// slide the window down: the entering row replaces the oldest
+			T *in = ring[sz];
+			int yin = y+dn+1;
+			if (yin < h)
+				boxBlurRow(src + (size_t) yin*w, w, dv, border, in);
+			else	memcpy(in, tail + (size_t) (yin-h)*w, w * sizeof(T));
+			boxAddRow(sum, in, ring[head], w);
+			ring[sz]   = ring[head];
+			ring[head] = in;
+			if (++head == sz) head = 0;
+		}
+	});
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// sharpenRow:
+//
+// Unsharp mask of one row: the difference between src and its blur,
+// clipped to 0..255, is scaled by fctr and added back to src. uchar rows
+// look the result up in lut instead of computing it in floating point.
+//
+static void
+sharpenRow(const uchar *src, const uchar *blur, int w, const uchar *lut, uchar *dst)
+{
+	for (int x = 0; x<w; x++) {
+		int d = src[x] - blur[x];
+		dst[x] = lut[src[x]*MXGRAY + (d > 0 ? d : 0)];
+	}
+}
+
+static void
+sharpenRow(const float *src, const float *blur, int w, double fctr, float *dst)
+{
+	for (int x = 0; x<w; x++)
+		dst[x] = CLIP(src[x] + CLIP((src[x] - blur[x]), 0, 255) * fctr, 0, 255);
+}
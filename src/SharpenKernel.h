@@ -0,0 +1,32 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// SharpenKernel.h - Headless unsharp mask kernel
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#ifndef SHARPENKERNEL_H
+#define SHARPENKERNEL_H
+
+#include "IP.h"
+#include "Border.h"
+using namespace IP;
+
+// ----------------------------------------------------------------------
+// sharpen parameters; filled in by the Sharpen widget or by a batch job
+//
+struct SharpenParams {
+	int	sz;		// blur filter size
+	double	fctr;		// sharpen factor
+	Border	border;		// pixels past the edges
+	int	bands;		// no. of bands of rows, run on the global thread pool;
+				// 0: one per pool thread, 1: serial
+
+	SharpenParams(int s = 1, double f = 1, int b = 0) : sz(s), fctr(f), bands(b) {}
+};
+
+bool	sharpen(ImagePtr I1, const SharpenParams &params, ImagePtr I2);
+
+#endif	// SHARPENKERNEL_H
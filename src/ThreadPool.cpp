@@ -0,0 +1,175 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// ThreadPool.cpp - Fixed-size worker pool for headless kernels and batch jobs
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#include "ThreadPool.h"
+#include <atomic>
+
+// ----------------------------------------------------------------------
+// one parallelFor() call; shared by the caller and the helpers it woke up
+//
+struct ThreadPool::Job {
+	std::function<void(int)>	fn;		// loop body
+	int				n;		// no. of iterations
+	std::atomic<int>		next;		// next unclaimed iteration
+	std::atomic<int>		done;		// no. of finished iterations
+	std::mutex			mutex;		// guards cond
+	std::condition_variable		cond;		// signals done == n
+};
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ThreadPool::ThreadPool:
+//
+// Constructor. Start nthreads-1 workers; the caller of parallelFor()
+// is the remaining thread.
+//
+ThreadPool::ThreadPool(int nthreads)
+	: m_size(nthreads > 0 ? nthreads : cores()),
+	  m_quit(false)
+{
+	for(int i = 1; i < m_size; ++i)
+		m_threads.push_back(std::thread(&ThreadPool::worker, this));
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ThreadPool::~ThreadPool:
+//
+// Destructor. Stop and join all workers.
+//
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_cond.notify_all();
+	for(size_t i = 0; i < m_threads.size(); ++i)
+		m_threads[i].join();
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ThreadPool::global:
+//
+// Pool shared by all kernels; created on first use with one thread per core.
+//
+ThreadPool&
+ThreadPool::global()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ThreadPool::cores:
+//
+// Number of hardware threads; at least 1.
+//
+int
+ThreadPool::cores()
+{
+	int n = std::thread::hardware_concurrency();
+	return n > 0 ? n : 1;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ThreadPool::parallelFor:
+//
+//! \brief	Call fn(i) for every i in [0, n) and return when all calls are done.
+//! \details	Iterations are claimed one at a time, so callers should pass
+//!		a few coarse iterations (e.g. bands of rows) rather than pixels.
+//! \param[in]	n  - no. of iterations.
+//! \param[in]	fn - loop body.
+//
+void
+ThreadPool::parallelFor(int n, const std::function<void(int)> &fn)
+{
+	if(n <= 0) return;
+
+	// trivial case: nothing to share
+	if(n == 1 || m_size == 1) {
+		for(int i = 0; i < n; ++i) fn(i);
+		return;
+	}
+
+	std::shared_ptr<Job> job(new Job);
+	job->fn   = fn;
+	job->n    = n;
+	job->next = 0;
+	job->done = 0;
+
+	// wake up as many helpers as there are iterations left for them
+	int helpers = n - 1 < m_size - 1 ? n - 1 : m_size - 1;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for(int i = 0; i < helpers; ++i)
+			m_queue.push_back(job);
+	}
+	if(helpers == 1)
+		m_cond.notify_one();
+	else	m_cond.notify_all();
+
+	// caller works on its own loop, then waits for iterations claimed by helpers
+	runJob(job.get());
+	std::unique_lock<std::mutex> lock(job->mutex);
+	while(job->done < n)
+		job->cond.wait(lock);
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ThreadPool::runJob:
+//
+// Claim and run iterations of job until none are left.
+//
+void
+ThreadPool::runJob(Job *job)
+{
+	int i;
+	while((i = job->next++) < job->n) {
+		job->fn(i);
+		if(++job->done == job->n) {
+			std::lock_guard<std::mutex> lock(job->mutex);
+			job->cond.notify_all();
+		}
+	}
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ThreadPool::worker:
+//
+// Worker thread loop: wait for jobs and help run them.
+//
+void
+ThreadPool::worker()
+{
+	for(;;) {
+		std::shared_ptr<Job> job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while(!m_quit && m_queue.empty())
+				m_cond.wait(lock);
+			if(m_quit) return;
+			job = m_queue.front();
+			m_queue.pop_front();
+		}
+		runJob(job.get());
+	}
+}
@@ -0,0 +1,56 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// ThreadPool.h - Fixed-size worker pool for headless kernels and batch jobs
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+
+//////////////////////////////////////////////////////////////////////////
+///
+/// \class ThreadPool
+/// \brief Fixed set of worker threads that run parallelFor() loops.
+///
+/// A pool of size n runs at most n iterations at once: n-1 workers plus
+/// the calling thread, which always takes part in its own loop. Because
+/// the caller never waits on an iteration nobody has claimed, a
+/// parallelFor() may be nested inside another one on the same pool.
+///
+//////////////////////////////////////////////////////////////////////////
+
+class ThreadPool {
+public:
+	ThreadPool	(int nthreads = 0);	// 0: one thread per core
+	~ThreadPool	();
+	int		size		() const { return m_size; }
+	void		parallelFor	(int n, const std::function<void(int)> &fn);
+
+	static ThreadPool&	global	();	// shared pool used by the kernels
+	static int		cores	();	// no. of hardware threads
+
+private:
+	struct Job;
+	void		worker		();
+	static void	runJob		(Job *);
+
+	int				m_size;		// concurrency including caller
+	bool				m_quit;		// workers exit when set
+	std::vector<std::thread>	m_threads;	// worker threads
+	std::deque<std::shared_ptr<Job> > m_queue;	// jobs waiting for helpers
+	std::mutex			m_mutex;	// guards m_queue and m_quit
+	std::condition_variable		m_cond;		// signals new jobs
+};
+
+#endif	// THREADPOOL_H
@@ -42,9 +42,7 @@ Threshold::applyFilter(ImagePtr I1, ImagePtr I2)
 	if(thr < 0 || thr > MXGRAY) return 0;
 
 	// apply filter
-	threshold(I1, thr, I2);
-
-	return 1;
+	return threshold(I1, ThresholdParams(thr), I2);
 }
 
 
@@ -121,39 +119,6 @@ Threshold::changeThr(int thr)
 
 
 
-// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-// Threshold::threshold:
-//
-// Threshold I1 using the 2-level mapping shown below.  Output is in I2.
-// val<thr: 0;	 val >= thr: MaxGray (255)
-//! \brief	Threshold I1 using the 3-level mapping shown below.
-//! \details	Output is in I2. val<t1: g1; t1<=val<t2: g2; t2<=val: g3
-//! \param[in]	I1  - Input image.
-//! \param[in]	thr - Threshold.
-//! \param[out]	I2  - Output image.
-//
-void
-Threshold::threshold(ImagePtr I1, int thr, ImagePtr I2) {
-	IP_copyImageHeader(I1, I2);
-	int w = I1->width();
-	int h = I1->height();
-	int total = w * h;
-
-	// compute lut[]
-	int i, lut[MXGRAY];
-	for(i=0; i<thr && i<MXGRAY; ++i) lut[i] = 0;
-	for(   ; i <= MaxGray;      ++i) lut[i] = MaxGray;
-
-	int type;
-	ChannelPtr<uchar> p1, p2, endd;
-	for(int ch = 0; IP_getChannel(I1, ch, p1, type); ch++) {
-		IP_getChannel(I2, ch, p2, type);
-		for(endd = p1 + total; p1<endd;) *p2++ = lut[*p1++];
-	}
-}
-
-
-
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // Threshold::reset:
 //
@@ -11,6 +11,7 @@
 #define THRESHOLD_H
 
 #include "ImageFilter.h"
+#include "ThresholdKernel.h"
 
 
 class Threshold : public ImageFilter {
@@ -22,9 +23,6 @@ public:
 	bool		applyFilter(ImagePtr, ImagePtr);   // apply filter to input to init output
 	void		reset		();		                     // reset parameters
 
-protected:
-	void threshold(ImagePtr I1, int thr, ImagePtr I2);
-
 protected slots:
 	void changeThr(int);
 
@@ -0,0 +1,58 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// ThresholdKernel.cpp - Headless threshold kernel
+//
+// Written by: George Wolberg, 2016
+// ======================================================================
+
+#include "ThresholdKernel.h"
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// threshold:
+//
+// Threshold I1 using the 2-level mapping shown below.  Output is in I2.
+// val<thr: 0;	 val >= thr: MaxGray (255)
+//! \brief	Threshold I1 using the 3-level mapping shown below.
+//! \details	Output is in I2. val<t1: g1; t1<=val<t2: g2; t2<=val: g3
+//!		Return 1 for success, 0 for failure.
+//! \param[in]	I1     - Input image.
+//! \param[in]	params - Threshold.
+//! \param[out]	I2     - Output image.
+//
+bool
+threshold(ImagePtr I1, const ThresholdParams &params, ImagePtr I2) {
+	// error checking
+	if(I1.isNull()) return 0;
+
+	PointLut lut;
+	if(!thresholdLut(params, lut)) return 0;
+
+	return pointLut(I1, lut, I2);
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// thresholdLut:
+//
+// Fill lut with the threshold mapping, for threshold() or a fused chain.
+// Return 1 for success, 0 for a threshold out of range.
+//
+bool
+thresholdLut(const ThresholdParams &params, PointLut &lut)
+{
+	if(params.thr < 0 || params.thr > MXGRAY) return 0;
+
+	int thr = params.thr;
+
+	// compute lut[]
+	int i;
+	for(i=0; i<thr && i<MXGRAY; ++i) lut.map[i] = 0;
+	for(   ; i <= MaxGray;      ++i) lut.map[i] = MaxGray;
+
+	return 1;
+}
@@ -0,0 +1,29 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// ThresholdKernel.h - Headless threshold kernel
+//
+// Written by: George Wolberg, 2016
+// ======================================================================
+
+#ifndef THRESHOLDKERNEL_H
+#define THRESHOLDKERNEL_H
+
+#include "IP.h"
+#include "PointLut.h"
+using namespace IP;
+
+// ----------------------------------------------------------------------
+// threshold parameters; filled in by the Threshold widget or by a batch job
+//
+struct ThresholdParams {
+	int	thr;		// threshold
+
+	ThresholdParams(int t = MXGRAY>>1) : thr(t) {}
+};
+
+bool	threshold(ImagePtr I1, const ThresholdParams &params, ImagePtr I2);
+bool	thresholdLut(const ThresholdParams &params, PointLut &lut);
+
+#endif	// THRESHOLDKERNEL_H
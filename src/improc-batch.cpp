@@ -0,0 +1,268 @@
+// ======================================================================
+// IMPROC: Image Processing Software Package
+// Copyright (C) 2016 by George Wolberg
+//
+// improc-batch.cpp - main() for headless batch processing.
+//
+// Usage: improc-batch [-j N] [-b N] [-c] [-o outdir] chain input...
+// Each input is an image file, a directory, or a quoted glob pattern.
+// With -b, each image is filtered N times and the best time is reported,
+// without file I/O; use it to compare kernels, e.g. blur:15 and sharpen:15.
+// With -c, each image is also filtered in one band and in bands of two
+// rows, and the image fails if the two results differ.
+//
+// Written by: Khadeeja Din, 2016
+// ======================================================================
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <glob.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "FilterChain.h"
+#include "ThreadPool.h"
+#include "Scratch.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// ----------------------------------------------------------------------
+// image file extensions picked up when an input is a directory
+//
+static const char *Extensions[] = {"jpg", "jpeg", "png", "ppm", "pgm", "bmp"};
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// extension:
+//
+// Return lowercase extension of file without the dot; empty if none.
+//
+static std::string
+extension(const std::string &file)
+{
+	size_t dot   = file.rfind('.');
+	size_t slash = file.rfind('/');
+	if(dot == std::string::npos || (slash != std::string::npos && dot < slash))
+		return "";
+	std::string ext = file.substr(dot+1);
+	std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+	return ext;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// isImage:
+//
+// Return 1 if file has one of the image extensions we read.
+//
+static bool
+isImage(const std::string &file)
+{
+	std::string ext = extension(file);
+	for(size_t i = 0; i < sizeof(Extensions)/sizeof(Extensions[0]); ++i)
+		if(ext == Extensions[i]) return 1;
+	return 0;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// collectFiles:
+//
+//! \brief	Expand one command-line input into image files.
+//! \details	A directory contributes its image files (not recursive);
+//!		anything else is expanded as a glob pattern.
+//! \param[in]	input - file, directory or glob pattern.
+//! \param[out]	files - list to append to.
+//
+static void
+collectFiles(const std::string &input, std::vector<std::string> &files)
+{
+	struct stat st;
+	if(stat(input.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+		DIR *dir = opendir(input.c_str());
+		if(!dir) return;
+		std::vector<std::string> list;
+		for(struct dirent *e; (e = readdir(dir)) != NULL; ) {
+			std::string file = input + "/" + e->d_name;
+			if(isImage(file)) list.push_back(file);
+		}
+		closedir(dir);
+
+		// readdir order is arbitrary; keep runs reproducible
+		std::sort(list.begin(), list.end());
+		files.insert(files.end(), list.begin(), list.end());
+		return;
+	}
+
+	glob_t g;
+	if(glob(input.c_str(), 0, NULL, &g) == 0) {
+		for(size_t i = 0; i < g.gl_pathc; ++i)
+			files.push_back(g.gl_pathv[i]);
+	}
+	globfree(&g);
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// sameImage:
+//
+// Return 1 if I1 and I2 have the same size, channels and pixels.
+//
+static bool
+sameImage(ImagePtr I1, ImagePtr I2)
+{
+	if(I1->width() != I2->width() || I1->height() != I2->height() ||
+	   I1->maxChannel() != I2->maxChannel()) return 0;
+
+	size_t total = (size_t) I1->width() * I1->height();
+	int t1, t2;
+	ChannelPtr<uchar> p1, p2;
+	for(int ch = 0; IP_getChannel(I1, ch, p1, t1); ch++) {
+		if(!IP_getChannel(I2, ch, p2, t2) || t1 != t2) return 0;
+
+		// the kernels write uchar or float channels
+		size_t bytes = total * (t1 == UCHAR_TYPE ? sizeof(uchar) : sizeof(float));
+		if(memcmp(&*p1, &*p2, bytes)) return 0;
+	}
+	return 1;
+}
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// usage:
+//
+// Print usage message and exit.
+//
+static void
+usage(const char *prog)
+{
+	fprintf(stderr,
+		"Usage: %s [-j N] [-b N] [-c] [-o outdir] chain input...\n"
+		"  -j N       process N images at once (default: no. of cores)\n"
+		"  -b N       benchmark: time the chain alone, best of N runs per image\n"
+		"  -c         check: fail images whose result in bands of two rows\n"
+		"             differs from that in a single band\n"
+		"  -o outdir  write results to outdir; without it results are discarded\n"
+		"  input      image file, directory, or quoted glob pattern\n\n%s",
+		prog, FilterChain::usage());
+	exit(1);
+}
+
+
+
+int main(int argc, char **argv)
+{
+	int		jobs = ThreadPool::cores();
+	int		bench = 0;
+	bool		check = 0;
+	std::string	outdir;
+	int		i;
+
+	// parse options
+	for(i = 1; i < argc && argv[i][0] == '-'; ++i) {
+		if(!strcmp(argv[i], "-j") && i+1 < argc)
+			jobs = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-b") && i+1 < argc)
+			bench = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-c"))
+			check = 1;
+		else if(!strcmp(argv[i], "-o") && i+1 < argc)
+			outdir = argv[++i];
+		else	usage(argv[0]);
+	}
+	if(argc - i < 2 || jobs < 1 || bench < 0) usage(argv[0]);
+
+	// parse filter chain
+	FilterChain chain;
+	std::string err;
+	if(!chain.parse(argv[i++], err)) {
+		fprintf(stderr, "%s: %s\n", argv[0], err.c_str());
+		return 1;
+	}
+
+	// the chain in a single band, for -c
+	FilterChain one = chain;
+	one.setBands(1);
+
+	// expand inputs
+	std::vector<std::string> files;
+	for(; i < argc; ++i)
+		collectFiles(argv[i], files);
+	if(files.empty()) {
+		fprintf(stderr, "%s: no input images\n", argv[0]);
+		return 1;
+	}
+
+	std::mutex		printMutex;
+	std::atomic<int>	failed(0);
+	std::atomic<long long>	pixels(0);
+
+	// process images on a bounded pool; each image is one iteration
+	ThreadPool pool(jobs);
+	Clock::time_point start = Clock::now();
+	pool.parallelFor((int) files.size(), [&](int k) {
+		const std::string &file = files[k];
+		Clock::time_point t0 = Clock::now();
+
+		ImagePtr I1 = IP_readImage(file.c_str());
+		ImagePtr I2;
+		bool ok = !I1.isNull() && chain.apply(I1, I2);
+
+		// benchmark: keep the fastest of the timed runs of the chain alone
+		double ms = 0;
+		for(int run = 0; ok && run < bench; ++run) {
+			Clock::time_point t1 = Clock::now();
+			ok = chain.apply(I1, I2);
+			double t = std::chrono::duration<double, std::milli>(Clock::now() - t1).count();
+			if(run == 0 || t < ms) ms = t;
+		}
+
+		// check: bands must not change the result. Bands of two rows
+		// each slide their window and read rows past their neighbors
+		if(ok && check) {
+			FilterChain rows = chain;
+			rows.setBands(MAX(1, I1->height() / 2));
+			ImagePtr A, B;
+			ok = one.apply(I1, A) && rows.apply(I1, B) && sameImage(A, B);
+		}
+		if(ok && !outdir.empty()) {
+			size_t slash = file.rfind('/');
+			std::string name = (slash == std::string::npos) ? file : file.substr(slash+1);
+			std::string out  = outdir + "/" + name;
+			ok = IP_saveImage(I2, out.c_str(), extension(out).c_str());
+		}
+
+		if(!bench) ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+		long long npix = ok ? (long long) I1->width() * I1->height() : 0;
+		pixels += npix;
+		if(!ok) ++failed;
+
+		std::lock_guard<std::mutex> lock(printMutex);
+		if(ok)	printf("%s  %dx%d  %.1f ms  %.1f MP/s\n", file.c_str(),
+				I1->width(), I1->height(), ms, npix / (ms * 1e3));
+		else	printf("%s  FAILED\n", file.c_str());
+		fflush(stdout);
+	});
+	double secs = std::chrono::duration<double>(Clock::now() - start).count();
+
+	// aggregate throughput
+	int n = (int) files.size() - failed;
+	printf("%d images (%d failed) in %.2f s with %d jobs: %.1f images/s, %.1f MP/s\n",
+		n, (int) failed, secs, jobs, n / secs, pixels / (secs * 1e6));
+
+	// heap traffic of kernel line buffers; flat once the arenas fit an image
+	ScratchStats st = Scratch::stats();
+	printf("scratch: %lld allocations, %.1f KB\n", st.allocations, st.bytes / 1024.);
+
+	return failed ? 1 : 0;
+}